@@ -0,0 +1,34 @@
+PUSH 0
+POP RAX
+PUSH 0
+POP RDX
+PUSH 1000000
+POP RBX
+
+PUSH 0
+PUSH 0
+loop:
+    POP RCX
+    POP RCX
+
+    PUSH RDX
+    PUSH RAX
+    ADD
+    POP RDX
+
+    PUSH 0
+    POP RCX
+    PUSH RAX
+    POP [RCX + 500]
+    PUSH [RCX + 500]
+    POP RCX
+
+    PUSH RAX + 1
+    POP RAX
+
+    PUSH RAX
+    PUSH RBX
+    JA loop:
+
+PUSH RDX
+OUT
@@ -7,29 +7,119 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <setjmp.h>
 
 
 //--------------------------------------------------------------------------------------------------
 
-const size_t RAM_CAPACITY = 1024;
+const size_t RAM_DEFAULT_SIZE      = 1024;
+const size_t SCREEN_DEFAULT_HEIGHT = 7;
+const size_t SCREEN_DEFAULT_WIDTH  = SCREEN_DEFAULT_HEIGHT * 2;
+
+
+struct FrameRenderer;
+
+
+/**
+ * Size of RAM and of screen at its beginning. Fields which are 0 aren't set.
+ */
+struct MemoryLayout
+{
+    size_t ramSize;                 /**< Cells of RAM.                                          */
+    size_t screenWidth;             /**< Pixels in row of screen.                               */
+    size_t screenHeight;
+};
 
 
 typedef int64_t memoryCell_t;
 struct RAM 
 {
     memoryCell_t* memory;
+    size_t        size;             /**< Cells of RAM.                                          */
+    size_t        screenWidth;
+    size_t        screenHeight;
+    size_t        mappedSize;       /**< Bytes of readable pages, memory ends at their end if 
+                                         RAM is guarded and starts at their beginning otherwise. */
+    size_t        reservedSize;     /**< Bytes of address space from the first readable page, 
+                                         pages after readable ones are guard pages.             */
+    size_t        mask;             /**< Cell numbers are masked by it if RAM is guarded, 
+                                         0 if RAM isn't guarded.                                */
+    size_t        faultCellNum;     /**< Cell whose access is caught by RamFaultCatch().        */
+    int           snapshotFd;       /**< File with copy of memory which is mapped by RamClone(),
+                                         -1 if there is no snapshot.                            */
+    bool          isChanged;        /**< Memory may be changed since snapshot is made.          */
 };
 
 
 //--------------------------------------------------------------------------------------------------
 
 
-bool RamInit(RAM* ram);
+/**
+ * Map memory of exactly layout->ramSize cells rounded up to page. Memory is only reserved,
+ * pages are allocated by the first write, so large RAM with few used cells is cheap.
+ *
+ * Guarded RAM ends right before guard pages which continue up to a power of two cells
+ * above RAM size, it isn't less than 2^24 cells. Then memory[cellNum & ram->mask] needs no check: cells out of RAM
+ * are caught by RamFaultCatch() and cells after the guard pages wrap around.
+ *
+ * @param layout    Complete layout, see MemoryLayoutChoose().
+ * @param isGuarded Make guard pages after RAM.
+ *
+ * @return false if screen doesn't fit in RAM or memory can't be mapped.
+ */
+bool RamInit(RAM* ram, const MemoryLayout* layout, bool isGuarded);
 void RamDelete(RAM* ram);
 
 bool RamGetValue(RAM* ram, size_t cellNum, memoryCell_t* valueBuffer);
 bool RamCellSet(RAM* ram, size_t cellNum, memoryCell_t value);
-void RamScreenDraw(RAM* ram);
+bool RamScreenDraw(RAM* ram, FrameRenderer* renderer);
+
+
+/**
+ * @return pages of RAM which are in physical memory now.
+ */
+size_t RamGetResidentPageCount(RAM* ram);
+
+
+/**
+ * Make copy of RAM which shares pages with source until one of them writes there.
+ * Snapshot of source is made by the first clone and reused by the next ones 
+ * until RamMarkChanged() is called.
+ */
+bool RamClone(RAM* source, RAM* clone);
+
+
+/**
+ * Catch accesses of this thread to guard pages of guarded RAM. SIGSEGV handler writes 
+ * the cell to ram->faultCellNum and jumps to faultJump by siglongjmp(). Other faults are 
+ * passed to the previous handler.
+ *
+ * @return false if handler can't be set.
+ */
+bool RamFaultCatch(RAM* ram, sigjmp_buf* faultJump);
+
+
+/**
+ * Stop catching of faults which is started by RamFaultCatch().
+ */
+void RamFaultRelease();
+
+
+/**
+ * Fill fields of layout which aren't set by fields of program layout and then by defaults.
+ *
+ * @param programLayout Layout which is written in program, may be NULL.
+ */
+void MemoryLayoutChoose(MemoryLayout* layout, const MemoryLayout* programLayout);
+
+
+/**
+ * Memory may be changed, so the next RamClone() needs a new snapshot.
+ */
+inline void RamMarkChanged(RAM* ram)
+{
+    ram->isChanged = true;
+}
 
 
 //--------------------------------------------------------------------------------------------------
@@ -16,13 +16,14 @@
  * Your code file must have .asm extension like *name*.asm .
  * Machin code file will have .vm extension and the same name: *name*.vm .
  * 
- * @param fileName Name of file with code. Don't forget .asm extension!
+ * @param fileName  Name of file with code. Don't forget .asm extension!
+ * @param isCompact Write code as compact bytecode which is smaller and is expanded at load.
  * 
  * @return true if assembling is complete,
  * @return false if there is an error. Error will be printed to terminal. 
  *         More detailed information about error you can find in logs/log.txt .
  */
-bool Assemble(const char* fileName);
+bool Assemble(const char* fileName, bool isCompact = false);
 
 
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,114 @@
+/**
+ * @file
+ * This header provides you batch of independent programs which are executed
+ * on a work-stealing pool of threads. Every program is loaded once, its machine code
+ * is shared by all jobs which run it. Every job has its own processor, input and output.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+
+#include "machineCode.h"
+#include "processor.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+struct BatchProgram
+{
+    char*       name;               /**< Name of assembly file.                         */
+    MachineCode machineCode;        /**< Read-only after loading, shared by jobs.       */
+};
+
+
+struct BatchJob
+{
+    size_t            programNum;
+    instruction_t*    inputs;       /**< Numbers which are read by IN.                  */
+    size_t            inputCount;
+
+    processorStatus_t status;       /**< Status after the end of the run.               */
+    size_t            executedCount;
+    char*             output;       /**< Null-terminated output of OUT.                 */
+    size_t            outputLength;
+};
+
+
+struct Batch
+{
+    BatchProgram* programs;
+    size_t        programCount;
+    size_t        programCapacity;
+
+    BatchJob*     jobs;
+    size_t        jobCount;
+    size_t        jobCapacity;
+};
+
+
+struct BatchOptions
+{
+    ProcessorOptions* processorOptions;     /**< Only fused or decoded code is used.        */
+    size_t            threadCount;          /**< If it is 0, number of cores is used.       */
+    size_t            instructionLimit;     /**< Job which executes more instructions is
+                                                 stopped. If it is 0, there is no limit.    */
+};
+
+
+struct BatchStats
+{
+    size_t threadCount;
+    size_t executedCount;
+    size_t stolenCount;             /**< Jobs executed by other thread than planned.    */
+    double executionSeconds;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Read batch from file. Every line of it is a job: name of assembly file and numbers
+ * for IN separated by spaces. Empty lines and lines which start with '#' are skipped.
+ * Every program is assembled and loaded once.
+ */
+bool BatchInitFromFile(Batch* batch, const char* fileName);
+
+
+void BatchDelete(Batch* batch);
+
+
+/**
+ * Execute all jobs. Jobs are given to threads in turn, a thread which has no jobs
+ * left steals them from others.
+ *
+ * @param stats Statistics of execution are written here if it isn't NULL.
+ *
+ * @return false if there is not enough memory. Status of every job is in the job.
+ */
+bool BatchRun(Batch* batch, BatchOptions* options, BatchStats* stats);
+
+
+/**
+ * Print status and output of every job in order of the batch file.
+ */
+void BatchPrintResults(Batch* batch);
+
+
+/**
+ * @return number of online cores.
+ */
+size_t BatchGetCoreCount();
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // BATCH_H
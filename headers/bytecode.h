@@ -0,0 +1,48 @@
+/**
+ * @file
+ * This header provides you compact bytecode which machine code is stored in .vm file with.
+ * Every command starts with one byte: cmdName in low 5 bits and PushPopMode of PUSH and POP
+ * in high 3 bits. Register is a byte with its index in low nibble, constants, jump targets
+ * and SYSCALL numbers are zig-zag varints. Processor executes word code, so bytecode is
+ * expanded to words at load in one pass.
+ */
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "machineCode.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * @param sizeBuffer Size of bytecode in bytes.
+ *
+ * @return allocated bytecode which must be freed,
+ * @return NULL if there is no memory or code can't be encoded: it has unknown command,
+ *         wrong PushPopMode or register which doesn't fit nibble.
+ */
+uint8_t* BytecodeEncode(const instruction_t* code, size_t instructionCount, size_t* sizeBuffer);
+
+
+/**
+ * @param code Buffer for exactly instructionCount words.
+ *
+ * @return false if bytecode is damaged or has other number of words.
+ */
+bool BytecodeDecode(const uint8_t* bytecode, size_t size, instruction_t* code,
+                    size_t instructionCount);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // BYTECODE_H
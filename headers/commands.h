@@ -142,12 +142,12 @@ DEF_CMD_(PUSH,
         instruction_t value;
         RamGetValue(&processor->ram, (size_t) result, &value);
         // ColoredPrintf(GREEN, "ram: push result = %zu, ram[result] = %zu\n", result, value);
-        StackPush(processor->stack, &value);
+        OPERAND_STACK_PUSH(value);
     }
     else 
     {
         // ColoredPrintf(GREEN, "push result = %zu\n", result);
-        StackPush(processor->stack, &result);
+        OPERAND_STACK_PUSH(result);
     }
 })
 
@@ -173,7 +173,7 @@ DEF_CMD_(POP,
     MachineCodeGetNextInstruction(&processor->machineCode, (instruction_t*) &popMode);
 
     instruction_t value = 0;
-    if (StackPop(processor->stack, &value) != OK)
+    if (!OPERAND_STACK_POP(value))
         ColoredPrintf(RED, "CAN'T POP!!!\n");  
     
     instruction_t nextInstruction = 0;
@@ -248,16 +248,15 @@ DEF_CMD_(POP,
 {                                                                       \
     instruction_t firstPoppedElem  = 0;                                 \
     instruction_t secondPoppedElem = 0;                                 \
-    if ((StackPop(processor->stack, &firstPoppedElem)  != OK) ||        \
-        (StackPop(processor->stack, &secondPoppedElem) != OK))          \
+    if (!OPERAND_STACK_POP(firstPoppedElem) ||                          \
+        !OPERAND_STACK_POP(secondPoppedElem))                           \
     {                                                                   \
-        LOG_PRINT(INFO, "Stack ptr = %p\n", processor->stack);          \
         ColoredPrintf(RED, "%s: POP ERROR\n", __FUNCTION__);            \
         return false;                                                   \
     }                                                                   \
                                                                         \
     instruction_t result = secondPoppedElem operation firstPoppedElem;  \
-    StackPush(processor->stack, &result);                               \
+    OPERAND_STACK_PUSH(result);                                         \
 }
 
 
@@ -275,13 +274,13 @@ DEF_CMD_(DIV,  SET_CMD_NO_ARGS_(DIV), DO_OPERATION_(/))
 #define DO_FUNCTION_(Function)                                              \
 {                                                                           \
     instruction_t arg = 0;                                                  \
-    if (StackPop(processor->stack, &arg)  != OK)                            \
+    if (!OPERAND_STACK_POP(arg))                                            \
     {                                                                       \
         ColoredPrintf(RED, "%s: POP ERROR\n", __FUNCTION__);                \
         return false;                                                       \
     }                                                                       \
     instruction_t result = (instruction_t) round(Function((double) arg));   \
-    StackPush(processor->stack, &result);                                   \
+    OPERAND_STACK_PUSH(result);                                             \
 }
 
 
@@ -302,10 +301,10 @@ DEF_CMD_(COS,  SET_CMD_NO_ARGS_(COS),  DO_FUNCTION_(cos))
 DEF_CMD_(IN, SET_CMD_NO_ARGS_(IN),
 {
     instruction_t inputNum = 0;
-    if (scanf("%ld", &inputNum) <= 0)
+    if (!IoChannelRead(&processor->io, &inputNum))
         return false;
 
-    StackPush(processor->stack, &inputNum);
+    OPERAND_STACK_PUSH(inputNum);
 })
 
 
@@ -316,13 +315,14 @@ DEF_CMD_(IN, SET_CMD_NO_ARGS_(IN),
 DEF_CMD_(OUT, SET_CMD_NO_ARGS_(OUT),
 {
     instruction_t lastElem = 0;
-    if (StackPop(processor->stack, &lastElem) != OK)
+    if (!OPERAND_STACK_POP(lastElem))
     {
         ColoredPrintf(RED, "OUT: POP ERROR\n");
         return false;
     }
 
-    ColoredPrintf(YELLOW, "%d\n", lastElem);
+    if (!IoChannelWrite(&processor->io, lastElem))
+        return false;
 })
 
 
@@ -332,7 +332,8 @@ DEF_CMD_(OUT, SET_CMD_NO_ARGS_(OUT),
 
 DEF_CMD_(DRAW, SET_CMD_NO_ARGS_(DRAW),
 {
-    RamScreenDraw(&processor->ram);
+    if (!RamScreenDraw(&processor->ram, &processor->renderer))
+        return false;
 })
 
 
@@ -372,8 +373,8 @@ DEF_CMD_(RET, SET_CMD_NO_ARGS_(RET),
     instruction_t lastInstruction    = 0;                       \
     instruction_t preLastInstruction = 0;                       \
                                                                 \
-    if (StackPop(processor->stack, &lastInstruction) != OK ||   \
-        StackPop(processor->stack, &preLastInstruction) != OK)  \
+    if (!OPERAND_STACK_POP(lastInstruction) ||                  \
+        !OPERAND_STACK_POP(preLastInstruction))                 \
     {                                                           \
         ColoredPrintf(RED, "%s: POP ERROR\n", __FUNCTION__);    \
         return false;                                           \
@@ -386,8 +387,8 @@ DEF_CMD_(RET, SET_CMD_NO_ARGS_(RET),
     else                                                        \
         MachineCodeSkipInstruction(&processor->machineCode);    \
                                                                 \
-    StackPush(processor->stack, &preLastInstruction);           \
-    StackPush(processor->stack, &lastInstruction);              \
+    OPERAND_STACK_PUSH(preLastInstruction);                     \
+    OPERAND_STACK_PUSH(lastInstruction);                        \
 }
 
 
@@ -418,4 +419,52 @@ DEF_CMD_(CALL, SET_JUMP_(CALL),
 
 #undef SET_JUMP_
 #undef DO_JUMP_IF_
-#undef DO_JUMP_
\ No newline at end of file
+#undef DO_JUMP_
+
+
+                                /////////////
+////////////////////////////////// SYSCALL /////////////////////////////////////////////////////////
+                                /////////////
+
+// SYSCALL n calls host function n which is set by ProcessorHostFunctionSet(),
+// it takes arguments from operand stack and pushes results there.
+DEF_CMD_(SYSCALL,
+{
+    MachineCodeAddInstruction(&assembler->machineCode, (instruction_t) SYSCALL);
+
+    char argBuffer[MAX_CMD_LENGTH + 1] = {};
+    instruction_t functionNum = 0;
+    if (GetNextWord(assembler, argBuffer) != CMD_OK || 
+        !ConvertToInstruction(argBuffer, &functionNum) || functionNum < 0)
+    {
+        LOG_PRINT(ERROR, "Wrong SYSCALL function number <%s>.\n", argBuffer);
+        return CMD_WRONG;
+    }
+
+    MachineCodeAddInstruction(&assembler->machineCode, functionNum);
+    return CMD_OK;
+},
+{
+    instruction_t functionNum = 0;
+    MachineCodeGetNextInstruction(&processor->machineCode, &functionNum);
+    HOST_FUNCTION_CALL_(functionNum);
+})
+
+
+
+                                ///////////
+////////////////////////////////// FLUSH ///////////////////////////////////////////////////////////
+                                ///////////
+
+// Write output which is buffered by text and binary I/O modes.
+DEF_CMD_(FLUSH,
+{
+    MachineCodeAddInstruction(&assembler->machineCode, (instruction_t) FLUSH);
+    SkipSpaces(assembler);
+    SkipComments(assembler);
+    return CMD_OK;
+},
+{
+    if (!IoChannelFlush(&processor->io))
+        return false;
+})
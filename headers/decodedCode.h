@@ -0,0 +1,114 @@
+/**
+ * @file
+ * This header provides you an interface to decode machine code once at program load.
+ * Decoded instructions have fixed size, resolved operands and specialised command names,
+ * so processor doesn't parse PushPopMode and operand words on every execution.
+ */
+
+#ifndef DECODED_CODE_H
+#define DECODED_CODE_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "machineCode.h"
+#include "pairProfile.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#define DEF_DECODED_CMD_(cmdName, ...) \
+    , DECODED_##cmdName
+
+enum DECODED_COMMAND_NAMES
+{
+    DECODED_CMD_NAME_WRONG
+    #include "decodedCommands.h"
+    , DECODED_CMD_COUNT
+};
+typedef enum DECODED_COMMAND_NAMES decodedCmdName_t;
+#undef DEF_DECODED_CMD_
+
+
+/**
+ * Registers are stored as indexes in Registers64, starting at 0.
+ * Superinstructions use secondRegisterNum and resultRegisterNum too.
+ */
+struct DecodedInstruction
+{
+    uint8_t       cmdName;              /**< decodedCmdName_t.                          */
+    uint8_t       registerNum;          /**< Register of PUSH/POP argument.             */
+    uint8_t       secondRegisterNum;
+    uint8_t       resultRegisterNum;
+    uint32_t      jumpTarget;           /**< Number of decoded instruction to jump to.  */
+    instruction_t immediate;            /**< Constant part of PUSH/POP argument.        */
+};
+
+
+struct DecodedCode
+{
+    DecodedInstruction* instructions;       /**< instructions[instructionCount] is HALT.      */
+    size_t              instructionCount;
+    size_t*             machineCodeNums;    /**< Machine code word where decoded instruction 
+                                                 starts, [instructionCount] is code size.     */
+    size_t*             decodedNums;        /**< Decoded instruction which contains machine 
+                                                 code word, [code size] is instructionCount.  */
+    size_t              machineCodeSize;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Decode whole machine code.
+ * 
+ * @param decodedCode Decoded code to init.
+ * @param machineCode Machine code to decode. It isn't changed.
+ * 
+ * @return true if machine code is decoded,
+ * @return false if machine code has wrong command, wrong operands or jump target which 
+ *         isn't a beginning of instruction. Error will be printed to logs/log.txt .
+ */
+bool DecodedCodeInit(DecodedCode* decodedCode, MachineCode* machineCode);
+
+
+void DecodedCodeDelete(DecodedCode* decodedCode);
+
+
+/**
+ * @return false if there is not enough memory, then copy is empty.
+ */
+bool DecodedCodeCopy(DecodedCode* source, DecodedCode* copy);
+
+
+/**
+ * Replace common sequences of decoded instructions with superinstructions 
+ * from decodedCommands.h . Sequences which contain jump target inside aren't replaced.
+ * 
+ * @param decodedCode Decoded code to change. Jump targets are renumbered.
+ * @param pairProfile Profile of executed command pairs. Sequence is replaced only 
+ *                    if all its command pairs are hot in this profile.
+ *                    If it is NULL, every sequence is replaced.
+ * 
+ * @return true if code is changed or there is nothing to fuse,
+ * @return false if there is not enough memory. Decoded code isn't changed then.
+ */
+bool DecodedCodeFuse(DecodedCode* decodedCode, PairProfile* pairProfile);
+
+
+const char* DecodedCmdGetName(decodedCmdName_t cmdName);
+
+
+bool DecodedCmdFromName(const char* name, decodedCmdName_t* cmdNameBuffer);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // DECODED_CODE_H
@@ -0,0 +1,342 @@
+// Commands of decoded code. They are executed with:
+//     processor      - Processor*,
+//     instruction    - DecodedInstruction* which is executed now,
+//     instructionNum - number of next decoded instruction.
+// Call stack keeps what CALL_STACK_FROM_DECODED_() makes from number of decoded instruction.
+// Constant RAM cells of verified programs are in RAM, so they aren't checked 
+// if CONST_CELLS_ARE_CHECKED_ is false. Other cells are read with RAM_GET_() and 
+// written with RAM_SET_().
+// IN reads with INPUT_READ_() and calls INPUT_MISSED_() if there is no input.
+// OUT writes with OUTPUT_WRITE_() and FLUSH writes buffered output with OUTPUT_FLUSH_().
+// DRAW draws screen with SCREEN_DRAW_().
+// SYSCALL calls host function with HOST_FUNCTION_CALL_(), it returns false if call is failed.
+// Superinstruction of LENGTH commands adds the rest of them to executed ones 
+// with FUSED_EXECUTED_(LENGTH), dispatch counts only the first one.
+
+
+#define REGISTER_(REGISTER_NUM) \
+    (((register64_t*) &processor->registers)[REGISTER_NUM])
+
+#define FIRST_REGISTER_  REGISTER_(instruction->registerNum)
+#define SECOND_REGISTER_ REGISTER_(instruction->secondRegisterNum)
+#define RESULT_REGISTER_ REGISTER_(instruction->resultRegisterNum)
+
+
+                             ///////////////
+/////////////////////////////// PUSH, POP //////////////////////////////////////////////////////////
+                             ///////////////
+
+#define DO_PUSH_(VALUE)                         \
+{                                               \
+    instruction_t pushedValue = VALUE;          \
+    OPERAND_STACK_PUSH(pushedValue);            \
+}
+
+#define DO_PUSH_RAM_(CELL_NUM)                                      \
+{                                                                   \
+    memoryCell_t cellValue = 0;                                     \
+    RAM_GET_((size_t) (CELL_NUM), cellValue);                       \
+    OPERAND_STACK_PUSH(cellValue);                                  \
+}
+
+#define DO_POP_(DESTINATION)                                \
+{                                                           \
+    instruction_t poppedValue = 0;                          \
+    if (!OPERAND_STACK_POP(poppedValue))                    \
+        ColoredPrintf(RED, "CAN'T POP!!!\n");               \
+                                                            \
+    DESTINATION;                                            \
+}
+
+
+DEF_DECODED_CMD_(PUSH_CONST,              DO_PUSH_(instruction->immediate))
+DEF_DECODED_CMD_(PUSH_REGISTER,           DO_PUSH_(FIRST_REGISTER_))
+DEF_DECODED_CMD_(PUSH_REGISTER_CONST,     DO_PUSH_(FIRST_REGISTER_ + instruction->immediate))
+DEF_DECODED_CMD_(PUSH_RAM_CONST,
+{
+    if (CONST_CELLS_ARE_CHECKED_)
+        DO_PUSH_RAM_(instruction->immediate)
+    else
+        OPERAND_STACK_PUSH(processor->ram.memory[instruction->immediate]);
+})
+DEF_DECODED_CMD_(PUSH_RAM_REGISTER,       DO_PUSH_RAM_(FIRST_REGISTER_))
+DEF_DECODED_CMD_(PUSH_RAM_REGISTER_CONST, DO_PUSH_RAM_(FIRST_REGISTER_ + instruction->immediate))
+
+DEF_DECODED_CMD_(POP_REGISTER,            DO_POP_(FIRST_REGISTER_ = poppedValue))
+DEF_DECODED_CMD_(POP_RAM_CONST,
+{
+    if (CONST_CELLS_ARE_CHECKED_)
+        DO_POP_(RAM_SET_((size_t) instruction->immediate, poppedValue))
+    else
+        DO_POP_(processor->ram.memory[instruction->immediate] = poppedValue)
+})
+DEF_DECODED_CMD_(POP_RAM_REGISTER,        DO_POP_(RAM_SET_((size_t) FIRST_REGISTER_, poppedValue)))
+DEF_DECODED_CMD_(POP_RAM_REGISTER_CONST,  DO_POP_(RAM_SET_((size_t) (FIRST_REGISTER_ + 
+                                                                     instruction->immediate),
+                                                           poppedValue)))
+
+#undef DO_PUSH_
+#undef DO_PUSH_RAM_
+#undef DO_POP_
+
+
+
+                                /////////////////////////
+                                // ADD, SUB, MUL, DIV, //
+////////////////////////////////// SQRT, SIN, COS,     /////////////////////////////////////////////
+                                // IN, OUT,            //
+                                // DRAW,               //
+                                // RET                 //
+                                /////////////////////////
+
+#define DO_OPERATION_(operation)                                        \
+{                                                                       \
+    instruction_t firstPoppedElem  = 0;                                 \
+    instruction_t secondPoppedElem = 0;                                 \
+    if (!OPERAND_STACK_POP(firstPoppedElem) ||                          \
+        !OPERAND_STACK_POP(secondPoppedElem))                           \
+    {                                                                   \
+        ColoredPrintf(RED, "%s: POP ERROR\n", __FUNCTION__);            \
+        return false;                                                   \
+    }                                                                   \
+                                                                        \
+    instruction_t result = secondPoppedElem operation firstPoppedElem;  \
+    OPERAND_STACK_PUSH(result);                                         \
+}
+
+DEF_DECODED_CMD_(ADD, DO_OPERATION_(+))
+DEF_DECODED_CMD_(SUB, DO_OPERATION_(-))
+DEF_DECODED_CMD_(MUL, DO_OPERATION_(*))
+DEF_DECODED_CMD_(DIV, DO_OPERATION_(/))
+#undef DO_OPERATION_
+
+
+#define DO_FUNCTION_(Function)                                              \
+{                                                                           \
+    instruction_t arg = 0;                                                  \
+    if (!OPERAND_STACK_POP(arg))                                            \
+    {                                                                       \
+        ColoredPrintf(RED, "%s: POP ERROR\n", __FUNCTION__);                \
+        return false;                                                       \
+    }                                                                       \
+    instruction_t result = (instruction_t) round(Function((double) arg));   \
+    OPERAND_STACK_PUSH(result);                                             \
+}
+
+DEF_DECODED_CMD_(SQRT, DO_FUNCTION_(sqrt))
+DEF_DECODED_CMD_(SIN,  DO_FUNCTION_(sin))
+DEF_DECODED_CMD_(COS,  DO_FUNCTION_(cos))
+#undef DO_FUNCTION_
+
+
+DEF_DECODED_CMD_(IN,
+{
+    instruction_t inputNum = 0;
+    if (!INPUT_READ_(inputNum))
+        INPUT_MISSED_();
+
+    OPERAND_STACK_PUSH(inputNum);
+})
+
+
+DEF_DECODED_CMD_(OUT,
+{
+    instruction_t lastElem = 0;
+    if (!OPERAND_STACK_POP(lastElem))
+    {
+        ColoredPrintf(RED, "OUT: POP ERROR\n");
+        return false;
+    }
+
+    OUTPUT_WRITE_(lastElem);
+})
+
+
+DEF_DECODED_CMD_(DRAW, SCREEN_DRAW_())
+
+
+DEF_DECODED_CMD_(RET,
+{
+    instruction_t returnNum = 0;
+    StackPop(processor->callStack, &returnNum);
+    instructionNum = CALL_STACK_TO_DECODED_(returnNum);
+})
+
+
+
+                            /////////////////////////////////////
+////////////////////////////// JMP, JA, JAE, JB, JBE, JE, JNE, /////////////////////////////////////
+                            // CALL                            //
+                            /////////////////////////////////////
+
+#define DO_JUMP_IF_(CONDITION)                                  \
+{                                                               \
+    instruction_t lastInstruction    = 0;                       \
+    instruction_t preLastInstruction = 0;                       \
+                                                                \
+    if (!OPERAND_STACK_POP(lastInstruction) ||                  \
+        !OPERAND_STACK_POP(preLastInstruction))                 \
+    {                                                           \
+        ColoredPrintf(RED, "%s: POP ERROR\n", __FUNCTION__);    \
+        return false;                                           \
+    }                                                           \
+                                                                \
+    if (lastInstruction CONDITION preLastInstruction)           \
+        instructionNum = instruction->jumpTarget;               \
+                                                                \
+    OPERAND_STACK_PUSH(preLastInstruction);                     \
+    OPERAND_STACK_PUSH(lastInstruction);                        \
+}
+
+DEF_DECODED_CMD_(JMP, instructionNum = instruction->jumpTarget)
+DEF_DECODED_CMD_(JA,  DO_JUMP_IF_(>))
+DEF_DECODED_CMD_(JAE, DO_JUMP_IF_(>=))
+DEF_DECODED_CMD_(JB,  DO_JUMP_IF_(<))
+DEF_DECODED_CMD_(JBE, DO_JUMP_IF_(<=))
+DEF_DECODED_CMD_(JE,  DO_JUMP_IF_(==))
+DEF_DECODED_CMD_(JNE, DO_JUMP_IF_(!=))
+#undef DO_JUMP_IF_
+
+
+DEF_DECODED_CMD_(CALL,
+{
+    instruction_t returnNum = CALL_STACK_FROM_DECODED_(instructionNum);
+    StackPush(processor->callStack, &returnNum);
+    instructionNum = instruction->jumpTarget;
+})
+
+
+// Sentinel after the last instruction. Verified programs are executed without 
+// checks of instructionNum, so they are finished here. Sentinel isn't a command 
+// of program, so its dispatch isn't counted.
+DEF_DECODED_CMD_(HALT,
+{
+    processor->executedCount--;
+    OPERAND_STACK_FLUSH_();
+    return true;
+})
+
+
+
+                                /////////////
+////////////////////////////////// SYSCALL /////////////////////////////////////////////////////////
+                                /////////////
+
+DEF_DECODED_CMD_(SYSCALL, HOST_FUNCTION_CALL_(instruction->immediate))
+
+
+
+                                ///////////
+////////////////////////////////// FLUSH ///////////////////////////////////////////////////////////
+                                ///////////
+
+DEF_DECODED_CMD_(FLUSH, OUTPUT_FLUSH_())
+
+
+
+                            /////////////////////////////////////
+////////////////////////////// SUPERINSTRUCTIONS               /////////////////////////////////////
+                            // made by DecodedCodeFuse()       //
+                            /////////////////////////////////////
+
+// PUSH reg1 (+ c) ; POP reg2
+DEF_DECODED_CMD_(FUSED_MOVE_REGISTER, 
+{
+    FUSED_EXECUTED_(2);
+    RESULT_REGISTER_ = FIRST_REGISTER_ + instruction->immediate;
+})
+
+// PUSH c ; POP reg2
+DEF_DECODED_CMD_(FUSED_MOVE_CONST,
+{
+    FUSED_EXECUTED_(2);
+    RESULT_REGISTER_ = instruction->immediate;
+})
+
+// PUSH [reg1 (+ c)] ; POP reg2
+DEF_DECODED_CMD_(FUSED_LOAD,
+{
+    FUSED_EXECUTED_(2);
+    memoryCell_t cellValue = 0;
+    RAM_GET_((size_t) (FIRST_REGISTER_ + instruction->immediate), cellValue);
+    RESULT_REGISTER_ = cellValue;
+})
+
+// PUSH reg1 ; POP [reg2 (+ c)]
+DEF_DECODED_CMD_(FUSED_STORE, 
+{
+    FUSED_EXECUTED_(2);
+    RAM_SET_((size_t) (SECOND_REGISTER_ + instruction->immediate), FIRST_REGISTER_);
+})
+
+// POP reg1 ; POP reg2
+DEF_DECODED_CMD_(FUSED_POP_POP,
+{
+    FUSED_EXECUTED_(2);
+    instruction_t poppedValue = 0;
+    if (!OPERAND_STACK_POP(poppedValue))
+        ColoredPrintf(RED, "CAN'T POP!!!\n");
+    FIRST_REGISTER_ = poppedValue;
+
+    poppedValue = 0;
+    if (!OPERAND_STACK_POP(poppedValue))
+        ColoredPrintf(RED, "CAN'T POP!!!\n");
+    SECOND_REGISTER_ = poppedValue;
+})
+
+
+// PUSH reg1 ; PUSH c    ; OPERATION ; POP result
+// PUSH reg1 ; PUSH reg2 ; OPERATION ; POP result
+#define DO_FUSED_OPERATION_(operation, SECOND_VALUE)                        \
+{                                                                           \
+    FUSED_EXECUTED_(4);                                                     \
+    RESULT_REGISTER_ = FIRST_REGISTER_ operation SECOND_VALUE;              \
+}
+
+#define DEF_FUSED_OPERATION_(CMD_NAME, operation)                                               \
+    DEF_DECODED_CMD_(FUSED_##CMD_NAME##_CONST,                                                  \
+                     DO_FUSED_OPERATION_(operation, instruction->immediate))                    \
+    DEF_DECODED_CMD_(FUSED_##CMD_NAME##_REGISTER,                                               \
+                     DO_FUSED_OPERATION_(operation, SECOND_REGISTER_))
+
+DEF_FUSED_OPERATION_(ADD, +)
+DEF_FUSED_OPERATION_(SUB, -)
+DEF_FUSED_OPERATION_(MUL, *)
+#undef DEF_FUSED_OPERATION_
+#undef DO_FUSED_OPERATION_
+
+
+// PUSH reg1 ; PUSH c    ; JUMP label
+// PUSH reg1 ; PUSH reg2 ; JUMP label
+#define DO_FUSED_JUMP_IF_(CONDITION, SECOND_VALUE)                          \
+{                                                                           \
+    FUSED_EXECUTED_(3);                                                     \
+    instruction_t lastInstruction    = SECOND_VALUE;                        \
+    instruction_t preLastInstruction = FIRST_REGISTER_;                     \
+                                                                            \
+    OPERAND_STACK_PUSH(preLastInstruction);                                 \
+    OPERAND_STACK_PUSH(lastInstruction);                                    \
+                                                                            \
+    if (lastInstruction CONDITION preLastInstruction)                       \
+        instructionNum = instruction->jumpTarget;                           \
+}
+
+#define DEF_FUSED_JUMP_(JUMP_NAME, CONDITION)                                                   \
+    DEF_DECODED_CMD_(FUSED_##JUMP_NAME##_CONST,                                                 \
+                     DO_FUSED_JUMP_IF_(CONDITION, instruction->immediate))                      \
+    DEF_DECODED_CMD_(FUSED_##JUMP_NAME##_REGISTER,                                              \
+                     DO_FUSED_JUMP_IF_(CONDITION, SECOND_REGISTER_))
+
+DEF_FUSED_JUMP_(JA,  >)
+DEF_FUSED_JUMP_(JAE, >=)
+DEF_FUSED_JUMP_(JB,  <)
+DEF_FUSED_JUMP_(JBE, <=)
+DEF_FUSED_JUMP_(JE,  ==)
+DEF_FUSED_JUMP_(JNE, !=)
+#undef DEF_FUSED_JUMP_
+#undef DO_FUSED_JUMP_IF_
+
+#undef FIRST_REGISTER_
+#undef SECOND_REGISTER_
+#undef RESULT_REGISTER_
+#undef REGISTER_
@@ -0,0 +1,55 @@
+/**
+ * @file
+ * This header provides you 64-bit FNV-1a hash which is used by label table,
+ * section checksums of machine code and hashes of frames.
+ */
+
+#ifndef FNV_HASH_H
+#define FNV_HASH_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+const uint64_t FNV_PRIME        = 1099511628211ull;
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Add one value to hash. Value is a byte in classic FNV-1a, but it may be a whole word.
+ */
+inline uint64_t FnvHashAdd(uint64_t hash, uint64_t value)
+{
+    return (hash ^ value) * FNV_PRIME;
+}
+
+
+/**
+ * FNV-1a of size bytes.
+ */
+inline uint64_t FnvHashGet(const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*) data;
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t byteNum = 0; byteNum < size; byteNum++)
+        hash = FnvHashAdd(hash, bytes[byteNum]);
+
+    return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // FNV_HASH_H
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * This header provides you frame file of headless DRAW. File has header and frames after it.
+ * Every frame is packed pixels of video memory or 64-bit hash of them. File is mapped to
+ * memory and grows twice when it is full, so DRAW copies frame without system calls.
+ */
+
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "videoMemory.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+const char     FRAME_FILE_SIGNATURE[8] = {'V', 'M', 'F', 'R', 'A', 'M', 'E', 'S'};
+const uint32_t FRAME_FILE_VERSION      = 1;
+
+
+enum FRAME_FILE_FLAGS
+{
+    FRAME_FILE_HASH_ONLY = 1 << 0,      /**< Frames are hashes instead of pixels.           */
+};
+
+
+struct FrameFileHeader
+{
+    char     signature[8];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t width;
+    uint32_t height;
+    uint64_t frameStep;                 /**< Only every frameStep-th DRAW is kept.          */
+    uint64_t frameCount;                /**< Frames in file.                                */
+    uint64_t drawCount;                 /**< DRAW commands which are executed.              */
+};
+
+
+/**
+ * Pixel in file, symbol and color are characters.
+ */
+struct PackedPixel
+{
+    char symbol;
+    char color;
+};
+
+
+struct FrameCapture
+{
+    int          fd;
+    char*        mapped;                /**< Header and frames, NULL if file isn't open.    */
+    size_t       mappedSize;
+    size_t       frameSize;
+    PackedPixel* packedFrame;           /**< Frame which is hashed in hash only file.       */
+};
+
+
+struct FrameFile
+{
+    const FrameFileHeader* header;
+    const char*            frames;
+    void*                  mapped;      /**< Header and frames, NULL if file isn't open. */
+    size_t                 mappedSize;
+    size_t                 frameSize;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Create frame file, old file is truncated.
+ *
+ * @param width     Size of screen, every frame must have it.
+ * @param frameStep If it is 0, every frame is kept.
+ */
+bool FrameCaptureOpen(FrameCapture* capture, const char* fileName, size_t width, size_t height,
+                      size_t frameStep, bool isHashOnly);
+
+
+/**
+ * Truncate file to written frames and close it. Nothing is done if file isn't open.
+ */
+void FrameCaptureClose(FrameCapture* capture);
+
+
+/**
+ * Count DRAW and add frame if it is kept.
+ *
+ * @return false if file can't grow or frame has other size.
+ */
+bool FrameCaptureAdd(FrameCapture* capture, VideoMemory* videoMemory);
+
+
+/**
+ * Map frame file for reading and check its header. Size of frames is in the header.
+ */
+bool FrameFileOpen(FrameFile* frameFile, const char* fileName);
+
+
+void FrameFileClose(FrameFile* frameFile);
+
+
+/**
+ * @param pixels Buffer for width * height pixels.
+ *
+ * @return false if there is no such frame or file has only hashes.
+ */
+bool FrameFileGetPixels(FrameFile* frameFile, size_t frameNum, Pixel* pixels);
+
+
+/**
+ * @return hash of frame, it is counted if file has pixels, or 0 if there is no such frame.
+ */
+uint64_t FrameFileGetHash(FrameFile* frameFile, size_t frameNum);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // FRAME_CAPTURE_H
@@ -0,0 +1,94 @@
+/**
+ * @file
+ * This header provides you renderer of video memory for DRAW. Renderer keeps the last
+ * emitted frame, so in diff mode only changed pixels are printed over it with cursor
+ * movements. Every frame is built in memory and written at once. In capture mode frames
+ * are added to frame file instead of terminal.
+ */
+
+#ifndef FRAME_RENDERER_H
+#define FRAME_RENDERER_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+
+#include "videoMemory.h"
+#include "ioChannel.h"
+#include "frameCapture.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+enum DRAW_MODES
+{
+    DRAW_MODE_AUTO,     /**< Diff mode if output is terminal, full mode otherwise.          */
+    DRAW_MODE_FULL,     /**< Every frame is printed under the previous one.                 */
+    DRAW_MODE_DIFF,     /**< Changed pixels are printed over the previous frame.            */
+    DRAW_MODE_CAPTURE   /**< Frames are added to frame file, nothing is printed.            */
+};
+typedef enum DRAW_MODES drawMode_t;
+
+
+/**
+ * Zero-initialized renderer draws in auto mode to stdout.
+ */
+struct FrameRenderer
+{
+    drawMode_t mode;
+    IoChannel* io;                  /**< Its output is flushed before frame, NULL for stdout.  */
+
+    Pixel*     lastFrame;           /**< Pixels which are on the screen now.                   */
+    size_t     width;               /**< Size of frames which buffers are allocated for.       */
+    size_t     height;
+    bool       isLastFrameShown;    /**< Nothing is printed after the last frame.              */
+    size_t     lastWrittenCount;    /**< Numbers written by io when the last frame is drawn.   */
+
+    char*      frame;               /**< Text of the frame which is built now.                 */
+    size_t     frameLength;
+
+    FrameCapture capture;           /**< Frame file of capture mode.                           */
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * @param io Channel which writes to the same file as renderer or NULL for stdout.
+ */
+void FrameRendererInit(FrameRenderer* renderer, drawMode_t mode, IoChannel* io);
+
+
+/**
+ * Switch renderer to capture mode. Frame file is closed by FrameRendererDelete().
+ *
+ * @param width      Size of screen which is drawn.
+ * @param frameStep  Only every frameStep-th frame is kept, 0 keeps every frame.
+ * @param isHashOnly Keep only hashes of frames.
+ */
+bool FrameRendererCaptureOpen(FrameRenderer* renderer, const char* fileName, size_t width,
+                              size_t height, size_t frameStep, bool isHashOnly);
+
+
+void FrameRendererDelete(FrameRenderer* renderer);
+
+
+/**
+ * Print video memory. Buffers are allocated by the first frame.
+ *
+ * @return false if there is not enough memory or output can't be written.
+ */
+bool FrameRendererDraw(FrameRenderer* renderer, VideoMemory* videoMemory);
+
+
+bool DrawModeFromString(const char* string, drawMode_t* drawModeBuffer);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // FRAME_RENDERER_H
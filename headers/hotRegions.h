@@ -0,0 +1,106 @@
+/**
+ * @file
+ * This header provides you counters of backward jumps and CALL targets which are used 
+ * by tiered execution. Region of machine code becomes hot when its header is reached 
+ * by such transfers often enough, then it is executed by faster tier.
+ */
+
+#ifndef HOT_REGIONS_H
+#define HOT_REGIONS_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+const size_t HOT_REGION_DEFAULT_THRESHOLD = 1000;
+
+
+struct HotRegion
+{
+    size_t headerNum;               /**< Machine code word where region starts.       */
+    size_t endNum;                  /**< Machine code word after the last one.        */
+    bool   isCallTarget;            /**< Region is a function, not a loop.            */
+    double tierUpSeconds;           /**< Time from the beginning of execution.        */
+    size_t enterCount;
+    size_t executedCount;           /**< Instructions executed by faster tier.        */
+};
+
+
+struct HotRegions
+{
+    size_t*    transferCounts;      /**< Backward jumps and calls to every word.      */
+    size_t*    regionNums;          /**< Number of region + 1 for every header word.  */
+    size_t     codeSize;
+    size_t     threshold;
+
+    HotRegion* regions;
+    size_t     regionCount;
+    size_t     regionCapacity;
+
+    double     tierUpSeconds;       /**< Time spent to prepare faster tier.           */
+    double     fastTierSeconds;     /**< Time spent in faster tier.                   */
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * @param threshold Number of transfers to header which makes region hot.
+ *                  If it is 0, HOT_REGION_DEFAULT_THRESHOLD is used.
+ */
+bool HotRegionsInit(HotRegions* hotRegions, size_t codeSize, size_t threshold);
+
+
+void HotRegionsDelete(HotRegions* hotRegions);
+
+
+/**
+ * Count backward jump or call to targetNum.
+ * 
+ * @return true if targetNum has become a header of hot region just now.
+ */
+inline bool HotRegionsCount(HotRegions* hotRegions, size_t targetNum)
+{
+    if (targetNum >= hotRegions->codeSize)
+        return false;
+
+    return ++hotRegions->transferCounts[targetNum] == hotRegions->threshold;
+}
+
+
+/**
+ * @return hot region which starts at headerNum or NULL if there is no such region.
+ */
+inline HotRegion* HotRegionsGet(HotRegions* hotRegions, size_t headerNum)
+{
+    if (headerNum >= hotRegions->codeSize || hotRegions->regionNums[headerNum] == 0)
+        return NULL;
+
+    return hotRegions->regions + hotRegions->regionNums[headerNum] - 1;
+}
+
+
+/**
+ * @return new hot region or NULL if there is not enough memory.
+ */
+HotRegion* HotRegionsAdd(HotRegions* hotRegions, size_t headerNum, size_t endNum, 
+                         bool isCallTarget, double tierUpSeconds);
+
+
+/**
+ * Print tier-up events, counters of every region and time spent in every tier.
+ */
+void HotRegionsPrint(HotRegions* hotRegions, double executionSeconds);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // HOT_REGIONS_H
@@ -0,0 +1,112 @@
+/**
+ * @file
+ * This header provides you input and output of IN and OUT commands. Text and binary
+ * modes are buffered: output is written when buffer is full, on FLUSH command or
+ * when channel is deleted. Colored mode prints every number at once.
+ */
+
+#ifndef IO_CHANNEL_H
+#define IO_CHANNEL_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+enum IO_MODES
+{
+    IO_MODE_COLORED,    /**< Yellow numbers by ColoredPrintf(), input by scanf().    */
+    IO_MODE_TEXT,       /**< Decimal numbers without colors, one number per line.   */
+    IO_MODE_BINARY      /**< Raw int64_t in host byte order.                        */
+};
+typedef enum IO_MODES ioMode_t;
+
+
+const size_t IO_BUFFER_CAPACITY = 1 << 16;
+
+/**
+ * Maximal length of decimal int64_t with sign.
+ */
+const size_t IO_NUMBER_MAX_LENGTH = 20;
+
+
+struct IoChannel
+{
+    ioMode_t mode;
+    int      inputFd;
+    int      outputFd;
+
+    char*    inputBuffer;
+    size_t   inputBegin;            /**< First byte which isn't read yet.         */
+    size_t   inputEnd;
+    bool     isInputEnded;
+
+    char*    outputBuffer;
+    size_t   outputLength;
+    size_t   writtenCount;          /**< Numbers which are written by OUT.        */
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * @param inputFd  File which is read by IN in text and binary modes.
+ * @param outputFd File which is written by OUT in text and binary modes.
+ */
+bool IoChannelInit(IoChannel* channel, ioMode_t mode, int inputFd, int outputFd);
+
+
+/**
+ * Flush output and free buffers.
+ */
+void IoChannelDelete(IoChannel* channel);
+
+
+/**
+ * @return false if there are no numbers left or input isn't a number.
+ */
+bool IoChannelRead(IoChannel* channel, int64_t* valueBuffer);
+
+
+/**
+ * @return false if output can't be written.
+ */
+bool IoChannelWrite(IoChannel* channel, int64_t value);
+
+
+/**
+ * Write all buffered output.
+ */
+bool IoChannelFlush(IoChannel* channel);
+
+
+/**
+ * Write the whole buffer to file, write() is repeated only if it writes a part.
+ */
+bool IoWrite(int fd, const char* buffer, size_t length);
+
+
+bool IoModeFromString(const char* string, ioMode_t* ioModeBuffer);
+
+
+/**
+ * Write decimal value to buffer without '\0'.
+ *
+ * @param buffer Buffer for at least IO_NUMBER_MAX_LENGTH characters.
+ *
+ * @return length of number.
+ */
+size_t IoNumberFormat(int64_t value, char* buffer);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // IO_CHANNEL_H
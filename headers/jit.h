@@ -0,0 +1,72 @@
+/**
+ * @file
+ * This header provides you a baseline JIT which translates decoded code to x86-64 code.
+ * Registers RAX-RDX of virtual machine are kept in r12-r15, RAM base in rbx and 
+ * top of operand stack in rbp. IN, OUT, FLUSH, DRAW and math commands call back to runtime.
+ */
+
+#ifndef JIT_H
+#define JIT_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "decodedCode.h"
+#include "register64.h"
+#include "RAM.h"
+#include "ioChannel.h"
+#include "frameRenderer.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+const size_t JIT_CALL_STACK_CAPACITY = 4096;
+
+
+struct JitCode
+{
+    uint8_t*       code;
+    size_t         codeCapacity;        /**< Size of mmap'ed code buffer.              */
+    instruction_t* operandStack;        /**< operandStack[0] is never used.            */
+    uint8_t**      callStack;           /**< Native return addresses of CALL.          */
+    uint8_t**      callStackTop;        /**< Place for next return address.            */
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Translate decoded code to native code. Translated code uses registers, RAM, I/O channel
+ * and renderer which are passed here, so they mustn't be moved until JitCodeDelete().
+ * Operand stack isn't checked by native code, so code must be verified by DecodedCodeVerify()
+ * and operandStackCapacity must exceed the depth it proves.
+ * 
+ * @return true if code is translated,
+ * @return false if host isn't x86-64, code has command which JIT doesn't support or 
+ *         there is not enough memory. Interpreter must be used then.
+ */
+bool JitCodeInit(JitCode* jitCode, DecodedCode* decodedCode, Registers64* registers, RAM* ram,
+                 IoChannel* io, FrameRenderer* renderer, size_t operandStackCapacity);
+
+
+/**
+ * @return true if program is finished,
+ * @return false if program is failed (IN can't read number, output or frame can't be 
+ *         written or call stack is overflowed).
+ */
+bool JitCodeRun(JitCode* jitCode);
+
+
+void JitCodeDelete(JitCode* jitCode);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // JIT_H
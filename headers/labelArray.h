@@ -5,30 +5,44 @@
 //--------------------------------------------------------------------------------------------------
 
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "logPrinter.h"
 
 
 //--------------------------------------------------------------------------------------------------
 
 
-const size_t MAX_LABEL_NAME_LENGTH = 32;
-const size_t LABEL_POISON_NUM      = (size_t) -1;
-const size_t LABEL_DUMMY_NUM       = (size_t) -2;
+const size_t LABEL_POISON_NUM = (size_t) -1;
 
 
+/**
+ * Slot of label table. Slot is empty if its instructionNum is LABEL_POISON_NUM.
+ */
 struct Label
 {
-    char   name[MAX_LABEL_NAME_LENGTH + 1];
-    size_t instructionNum;
+    size_t   nameOffset;            /**< Name in names of LabelArray.          */
+    size_t   nameLength;
+    uint64_t hash;
+    size_t   instructionNum;
 };
 
 
-const size_t MAX_LABEL_COUNT = 128;
+const size_t LABEL_ARRAY_MIN_CAPACITY = 128;
 
+/**
+ * Open addressing hash table of labels. It is at most half full and grows twice,
+ * names are interned one after another in one buffer.
+ */
 struct LabelArray
 {
     Label* data;
+    size_t capacity;                /**< Slots, power of 2.                    */
     size_t labelCount;
+    char*  names;                   /**< Names with '\0' after every one.      */
+    size_t namesSize;
+    size_t namesCapacity;
 };
 
 
@@ -50,21 +64,32 @@ void LabelArrayDump(LabelArray* labelArray, Place place);
     LabelArrayDump(labelArrayPtr, GET_PLACE())
 
 
-bool LabelAdd(LabelArray* labelArray, char* labelName, const size_t instructionNum);
-
-
-bool LabelChangeInstructionNum(LabelArray* labelArray, char* labelName, 
-                               const size_t newInstructionNum);
+/**
+ * Name of label may be a word of source without '\0' after it, it is copied to the table.
+ *
+ * @return false if label exists or there is no memory.
+ */
+bool LabelAdd(LabelArray* labelArray, const char* labelName, size_t nameLength, 
+              const size_t instructionNum);
 
 
-bool LabelAddOrChangeInstructionNum(LabelArray* labelArray, char* labelName,
-                                    const size_t newInstructionNum);
+/**
+ * Table is verified on every search only in debug build.
+ */
+bool LabelFind(LabelArray* labelArray, const char* labelName, size_t nameLength, 
+               size_t* instructionNumBuffer);
 
 
-bool LabelFind(LabelArray* labelArray, char* labelName, size_t* instructionNumBuffer);
+/**
+ * Word is label if it ends by ':'.
+ */
+bool LabelIs(const char* word, size_t wordLength);
 
 
-bool LabelIs(char* labelName);
+/**
+ * FnvHashGet() of name, it is hash of Label.
+ */
+uint64_t LabelNameGetHash(const char* labelName, size_t nameLength);
 
 
 //--------------------------------------------------------------------------------------------------
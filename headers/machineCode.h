@@ -8,17 +8,40 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "RAM.h"
+
 
 //--------------------------------------------------------------------------------------------------
 
 
 typedef int64_t instruction_t;
 
+
+/**
+ * Line of .asm file where command starts. Lines are sorted by instructionNum.
+ */
+struct MachineCodeLine
+{
+    uint64_t instructionNum;
+    uint64_t lineNum;
+};
+
+
 struct MachineCode
  {
     size_t instructionCount;
     size_t instructionNum;
     instruction_t* code;
+    size_t codeCapacity;            /**< Allocated instructions of code which is assembled. */
+    bool isOverflowed;              /**< Instruction wasn't added, there was no memory.     */
+    MemoryLayout layout;            /**< RAM and screen which are set by program.  */
+    MachineCodeLine* lines;         /**< Line table, it may be empty.              */
+    size_t lineCount;
+    size_t lineCapacity;
+    void* mapped;                   /**< .vm file which code and lines are in, 
+                                         NULL if they are allocated.               */
+    size_t mappedSize;
+    bool isCodeAllocated;           /**< Code is decoded from bytecode of mapped file. */
  };
 
 
@@ -52,12 +75,67 @@ const size_t FIRST_INSTRUCTION_NUM = 0;
 const char* const MACHINE_CODE_FILE_EXTENSION = ".vm";
 
 
+/**
+ * .vm file is header, section table and sections. Files without signature are old ones:
+ * instruction count and instructions.
+ */
+const char     MACHINE_CODE_FILE_SIGNATURE[8] = {'V', 'M', 'C', 'O', 'D', 'E', '\r', '\n'};
+const uint32_t MACHINE_CODE_FILE_VERSION      = 1;
+
+/**
+ * Code section starts at multiple of it, so its pages are mapped read-only from file
+ * and shared by all processes which execute it.
+ */
+const size_t MACHINE_CODE_SECTION_ALIGNMENT = 4096;
+
+
+enum MACHINE_CODE_SECTION_TYPES
+{
+    SECTION_CODE     = 1,   /**< Instructions.                                      */
+    SECTION_LAYOUT   = 2,   /**< RAM size, screen width and height as uint64_t.     */
+    SECTION_LINES    = 3,   /**< Line table of MachineCodeLine.                     */
+    SECTION_BYTECODE = 4,   /**< Instruction count as uint64_t and bytecode.h code, 
+                                 it is written instead of code section.             */
+};
+
+
+struct MachineCodeFileHeader
+{
+    char     signature[8];
+    uint32_t version;
+    uint32_t flags;                 /**< Reserved, 0.                                   */
+    uint64_t sectionCount;          /**< Sections in table after header.                */
+};
+
+
+/**
+ * Sections of unknown types are skipped, so new sections can be added without new version.
+ */
+struct MachineCodeSection
+{
+    uint32_t type;
+    uint32_t flags;                 /**< Reserved, 0.                                   */
+    uint64_t offset;                /**< From the beginning of file.                    */
+    uint64_t size;                  /**< In bytes.                                      */
+    uint64_t checksum;              /**< FNV-1a of section.                             */
+};
+
+
 //--------------------------------------------------------------------------------------------------
 
 
+/**
+ * Code for assembler, it grows twice when it is full, so appending is amortised O(1) 
+ * and code is contiguous for one write to file.
+ */
 bool MachineCodeInit(MachineCode* machineCode);
 
 
+/**
+ * .vm file is mapped and code is executed from it without copying. Only small sections 
+ * are checked by checksums, code is checked only in debug build, so program of any size 
+ * is loaded at once.
+ */
 bool MachineCodeInitFromFile(MachineCode* machineCode, char* fileName);
 
 
@@ -75,7 +153,22 @@ codeStatus_t MachineCodeJump(MachineCode* machineCode, const jumpMode_t jumpMode
                                                        const int64_t    instructionShift);
 
 
-bool MachineCodeWriteToFile(MachineCode* machineCode, char* fileName);
+/**
+ * @param isCompact Write code as bytecode, it is written as instructions if it can't be encoded.
+ */
+bool MachineCodeWriteToFile(MachineCode* machineCode, char* fileName, bool isCompact = false);
+
+
+/**
+ * Command which starts at current instruction is at lineNum of .asm file.
+ */
+bool MachineCodeAddLine(MachineCode* machineCode, size_t lineNum);
+
+
+/**
+ * @return line of command which contains instructionNum or 0 if it is unknown.
+ */
+size_t MachineCodeGetLineNum(MachineCode* machineCode, size_t instructionNum);
 
 
 size_t MachineCodeGetInstructionNum(MachineCode* machineCode);
@@ -84,6 +177,22 @@ size_t MachineCodeGetInstructionNum(MachineCode* machineCode);
 void MachineCodeSkipInstruction(MachineCode* machineCode);
 
 
+/**
+ * Code and lines are resized to so many of them, new ones aren't set. It is for code 
+ * which is written by parts, its size is known and it isn't grown twice.
+ */
+bool MachineCodeResize(MachineCode* machineCode, size_t instructionCount, size_t lineCount);
+
+
+/**
+ * Code of part is written from instructionShift and lines of part are written 
+ * from lineTableShift, instructionShift and lineShift are added to their numbers.
+ * Different parts may be written at once.
+ */
+void MachineCodeWritePart(MachineCode* machineCode, const MachineCode* part, 
+                          size_t instructionShift, size_t lineTableShift, size_t lineShift);
+
+
 //--------------------------------------------------------------------------------------------------
 
 
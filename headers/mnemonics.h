@@ -0,0 +1,50 @@
+/**
+ * @file
+ * This header provides you names of commands and registers in both directions.
+ * Names are looked up by perfect hash tables which are built from commands.h and
+ * registers.h at compile time, so every word is hashed once and compared once.
+ * Numbers are turned to names by index, it is for printing code back as text.
+ */
+
+#ifndef MNEMONICS_H
+#define MNEMONICS_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include "virtualMachine.h"
+#include "register64.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * @return command or CMD_NAME_WRONG if there is no such command.
+ */
+cmdName_t CmdNameFromString(const char* string);
+
+
+/**
+ * @return name of command or "WRONG" if there is no such command.
+ */
+const char* CmdNameToString(instruction_t cmdName);
+
+
+/**
+ * @return register or REGISTER_NAME_WRONG if there is no such register.
+ */
+registerName_t RegisterNameFromString(const char* string);
+
+
+/**
+ * @return name of register or "WRONG" if there is no such register.
+ */
+const char* RegisterNameToString(instruction_t registerName);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // MNEMONICS_H
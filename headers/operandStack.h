@@ -0,0 +1,132 @@
+/**
+ * @file
+ * This header provides you an operand stack which lives inside Processor.
+ * Top element of the stack is cached in topValue, so when processor copies the stack 
+ * to local variable, top element and stack pointer are kept in host registers.
+ * 
+ * In release version push and pop are checked only if OPERAND_STACK_IS_CHECKED_ is true,
+ * checked push grows full stack twice. Switch, threaded and tiered dispatch and decoded
+ * dispatch of unverified programs are checked. Only verified decoded programs and native
+ * code of JIT are executed without checks: verifier proves that they don't pop empty stack
+ * or push more than capacity elements and stack is allocated for depth which it proves.
+ * Debug version (with _DEBUG) uses checked Stack instead.
+ */
+
+#ifndef OPERAND_STACK_H
+#define OPERAND_STACK_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+
+#include "machineCode.h"
+#include "stack.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+const size_t OPERAND_STACK_DEFAULT_CAPACITY = 4096;
+
+/**
+ * Verified program may have so many elements, its stack is allocated for them at load.
+ */
+const size_t OPERAND_STACK_MAX_VERIFIED_CAPACITY = 1 << 20;
+
+
+struct OperandStack
+{
+    instruction_t* data;        /**< data[0] is never used, so first push needs no check. */
+    instruction_t* top;         /**< Place of element under topValue.                     */
+    instruction_t  topValue;
+    size_t         capacity;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool OperandStackInit(OperandStack* operandStack, size_t capacity);
+
+
+void OperandStackDelete(OperandStack* operandStack);
+
+
+size_t OperandStackGetSize(OperandStack* operandStack);
+
+
+/**
+ * Grow stack to capacity elements, elements are kept. Smaller capacity changes nothing.
+ */
+bool OperandStackReserve(OperandStack* operandStack, size_t capacity);
+
+
+/**
+ * Init copy with the same capacity and elements as source.
+ */
+bool OperandStackCopy(OperandStack* source, OperandStack* copy);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/*
+ * Commands use OPERAND_STACK_PUSH() and OPERAND_STACK_POP(). Before including commands 
+ * processor must define OPERAND_STACK_ as OperandStack which is used and 
+ * OPERAND_STACK_IS_CHECKED_ as compile time constant. If OPERAND_STACK_ is a local copy,
+ * OPERAND_STACK_FLUSH_() and OPERAND_STACK_RELOAD_() copy it to processor and back:
+ * push grows operand stack of processor, so copy never owns freed memory.
+ * OPERAND_STACK_POP() is true if element is popped. OPERAND_STACK_PUSH() returns false 
+ * from processor's function if stack is full and can't grow.
+ */
+#ifdef _DEBUG
+
+    #define OPERAND_STACK_PUSH(VALUE)                   \
+    {                                                   \
+        instruction_t pushedValue_ = (VALUE);           \
+        StackPush(processor->stack, &pushedValue_);     \
+    }
+
+    #define OPERAND_STACK_POP(VALUE_BUFFER) \
+        (StackPop(processor->stack, &(VALUE_BUFFER)) == OK)
+
+#else
+
+    #define OPERAND_STACK_PUSH(VALUE)                                                   \
+    {                                                                                   \
+        instruction_t pushedValue_ = (VALUE);                                           \
+        if (OPERAND_STACK_IS_CHECKED_ &&                                                \
+            OPERAND_STACK_.top == OPERAND_STACK_.data + OPERAND_STACK_.capacity)        \
+        {                                                                               \
+            OPERAND_STACK_FLUSH_();                                                     \
+            bool isGrown_ = OperandStackReserve(&processor->operandStack,               \
+                                                2 * processor->operandStack.capacity);  \
+            OPERAND_STACK_RELOAD_();                                                    \
+                                                                                        \
+            if (!isGrown_)                                                              \
+            {                                                                           \
+                ColoredPrintf(RED, "OPERAND STACK OVERFLOW\n");                         \
+                return false;                                                           \
+            }                                                                           \
+        }                                                                               \
+                                                                                        \
+        *(++OPERAND_STACK_.top)    = OPERAND_STACK_.topValue;                           \
+        OPERAND_STACK_.topValue    = pushedValue_;                                      \
+    }
+
+    #define OPERAND_STACK_POP(VALUE_BUFFER)                                             \
+        ((OPERAND_STACK_IS_CHECKED_ && OPERAND_STACK_.top == OPERAND_STACK_.data) ?     \
+         false :                                                                        \
+         ((VALUE_BUFFER)          = OPERAND_STACK_.topValue,                            \
+          OPERAND_STACK_.topValue = *(OPERAND_STACK_.top--),                            \
+          true))
+
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // OPERAND_STACK_H
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * This header provides you a profile of decoded command pairs which are executed 
+ * one after another. It is collected by processor and used to choose superinstructions.
+ */
+
+#ifndef PAIR_PROFILE_H
+#define PAIR_PROFILE_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Pair is hot if it makes at least 1/PAIR_PROFILE_HOT_DIVIDER of all executed pairs.
+ */
+const size_t PAIR_PROFILE_HOT_DIVIDER = 100;
+
+
+struct PairProfile
+{
+    size_t* pairCounts;     /**< pairCounts[first * cmdCount + second] */
+    size_t  cmdCount;
+    size_t  pairCount;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool PairProfileInit(PairProfile* pairProfile, size_t cmdCount);
+
+
+void PairProfileDelete(PairProfile* pairProfile);
+
+
+inline void PairProfileAdd(PairProfile* pairProfile, size_t firstCmd, size_t secondCmd)
+{
+    pairProfile->pairCounts[firstCmd * pairProfile->cmdCount + secondCmd]++;
+    pairProfile->pairCount++;
+}
+
+
+size_t PairProfileGetCount(PairProfile* pairProfile, size_t firstCmd, size_t secondCmd);
+
+
+bool PairProfileIsHot(PairProfile* pairProfile, size_t firstCmd, size_t secondCmd);
+
+
+/**
+ * Write profile as text: one "FIRST SECOND COUNT" line for every executed pair,
+ * the most frequent pairs go first.
+ */
+bool PairProfileWriteToFile(PairProfile* pairProfile, const char* fileName);
+
+
+bool PairProfileInitFromFile(PairProfile* pairProfile, size_t cmdCount, const char* fileName);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // PAIR_PROFILE_H
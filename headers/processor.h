@@ -5,7 +5,229 @@
 //--------------------------------------------------------------------------------------------------
 
 
-bool ExecuteProgram(const char* programName);
+#include <stddef.h>
+
+#include "machineCode.h"
+#include "RAM.h"
+#include "ioChannel.h"
+#include "frameRenderer.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Ways to dispatch instructions of the program.
+ */
+enum DISPATCH_MODES
+{
+    DISPATCH_SWITCH,    /**< One InstructionExecute() call and one switch per instruction.  */
+    DISPATCH_THREADED,  /**< Computed goto from the end of every command to the next one.   */
+    DISPATCH_DECODED,   /**< Threaded dispatch of code decoded once at program load.        */
+    DISPATCH_FUSED,     /**< Decoded code with common sequences fused to superinstructions. */
+    DISPATCH_JIT,       /**< Verified decoded code translated to native code. Decoded 
+                             dispatch is used if it isn't verified or can't be translated.  */
+    DISPATCH_TIERED     /**< Cold code is interpreted, hot loops and functions are fused.   */
+};
+typedef enum DISPATCH_MODES dispatchMode_t;
+
+
+struct ProcessorOptions
+{
+    dispatchMode_t dispatchMode;
+    const char*    pairProfileName;         /**< Superinstructions are chosen by this profile.  */
+    const char*    pairProfileWriteName;    /**< Executed pairs of decoded commands are written 
+                                                 here in decoded and fused modes.               */
+    size_t         tierUpThreshold;         /**< Backward jumps or calls which make region hot.
+                                                 If it is 0, default threshold is used.         */
+    bool           isTierReportNeeded;      /**< Print hot regions and time of every tier.      */
+    ioMode_t       ioMode;                  /**< Format and buffering of IN and OUT.            */
+    drawMode_t     drawMode;                /**< Whole frames or changes are printed by DRAW.   */
+    const char*    frameFileName;           /**< DRAW adds frames here instead of terminal.     */
+    size_t         frameStep;               /**< Only every frameStep-th frame is kept.         */
+    bool           isFrameHashOnly;         /**< Keep only hashes of frames.                    */
+    bool           isRamGuarded;            /**< RAM has guard pages, decoded and fused modes 
+                                                 don't check its cells then.                    */
+    MemoryLayout   layout;                  /**< Its fields which are set override layout of 
+                                                 program.                                       */
+};
+
+
+struct ExecutionStats
+{
+    size_t executedCount;
+    double executionSeconds;
+    size_t ramSize;                 /**< Bytes of RAM address space.                            */
+    size_t ramResidentSize;         /**< Bytes of RAM which are in physical memory at exit.     */
+};
+
+
+/**
+ * Processor which is executed by parts with ProcessorRun(). All its state is kept 
+ * between runs, so thousands of programs can be time-sliced on a few threads.
+ */
+struct Processor;
+
+
+enum PROCESSOR_STATUSES
+{
+    PROCESSOR_BUDGET_EXHAUSTED,     /**< Run can be continued.                          */
+    PROCESSOR_FINISHED,
+    PROCESSOR_WAITING_FOR_INPUT,    /**< IN needs number from ProcessorInputAdd().      */
+    PROCESSOR_ERROR
+};
+typedef enum PROCESSOR_STATUSES processorStatus_t;
+
+
+/**
+ * Function of host which is called by SYSCALL of the program. It pops arguments 
+ * with ProcessorPop() and pushes results with ProcessorPush().
+ * 
+ * @param context Pointer which is given to ProcessorHostFunctionSet().
+ * 
+ * @return false if program must be stopped with error.
+ */
+typedef bool (*hostFunction_t)(Processor* processor, void* context);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Execute program from machine code file.
+ * 
+ * @param programName Name of file with machine code.
+ * @param options     Options of execution. If it is NULL, threaded dispatch is used.
+ * @param stats       Statistics of execution are written here if it isn't NULL.
+ * 
+ * @return true if program is executed,
+ * @return false if there is an error.
+ */
+bool ExecuteProgram(const char* programName, ProcessorOptions* options = NULL,
+                                             ExecutionStats* stats     = NULL);
+
+
+bool DispatchModeFromString(const char* string, dispatchMode_t* dispatchModeBuffer);
+
+
+/**
+ * @return seconds of monotonic clock, only difference of two values has meaning.
+ */
+double GetSeconds();
+
+
+/**
+ * Load and decode program for ProcessorRun().
+ * 
+ * @param options Options of execution. Code is fused in DISPATCH_FUSED mode, 
+ *                other modes use decoded code. If it is NULL, decoded code is used.
+ * 
+ * @return new processor or NULL if program can't be loaded or decoded.
+ */
+Processor* ProcessorCreate(const char* programName, ProcessorOptions* options = NULL);
+
+
+/**
+ * Same as ProcessorCreate(), but program is taken from machineCode which isn't copied. 
+ * It is only read, so many processors on different threads can share it. 
+ * It must live until all of them are destroyed.
+ */
+Processor* ProcessorCreateFromCode(const MachineCode* machineCode, 
+                                   ProcessorOptions*  options = NULL);
+
+
+void ProcessorDestroy(Processor* processor);
+
+
+/**
+ * Make processor which continues from the same state: registers, stacks, next instruction,
+ * input and output are copied. RAM pages are shared until one of processors writes there, 
+ * so clones of the same state don't copy RAM.
+ * 
+ * @return new processor or NULL if there is not enough memory.
+ */
+Processor* ProcessorClone(Processor* processor);
+
+
+/**
+ * Continue program from the place where the last run is stopped. Processor has no screen,
+ * so DRAW stops program with error.
+ * 
+ * @param instructionBudget  Maximum of instructions to execute, 0 means no limit.
+ *                           Superinstruction is counted as all of its commands, so budget 
+ *                           can be exceeded by less than length of superinstruction.
+ * @param microsecondBudget  Maximum of time to execute, 0 means no limit. 
+ *                           Time is checked once in many instructions, so it can be exceeded 
+ *                           a bit.
+ * 
+ * @return status of program. Finished program and program with error aren't executed anymore.
+ */
+processorStatus_t ProcessorRun(Processor* processor, size_t instructionBudget, 
+                                                     size_t microsecondBudget);
+
+
+/**
+ * Add number which is read by IN of the program, programs run by ProcessorRun() don't read stdin.
+ */
+bool ProcessorInputAdd(Processor* processor, instruction_t value);
+
+
+size_t ProcessorGetExecutedCount(Processor* processor);
+
+
+/**
+ * @return bytes of RAM which are in physical memory, pages which are never written aren't.
+ */
+size_t ProcessorGetRamResidentSize(Processor* processor);
+
+
+/**
+ * Numbers printed by OUT of the program, programs run by ProcessorRun() don't write to stdout.
+ * 
+ * @param lengthBuffer Length of output is written here.
+ * 
+ * @return null-terminated output, one number per line. It is valid until the next run.
+ */
+const char* ProcessorGetOutput(Processor* processor, size_t* lengthBuffer);
+
+
+/**
+ * Set function which is called by SYSCALL functionNum. Clones of processor have 
+ * the same functions.
+ * 
+ * @param function If it is NULL, SYSCALL functionNum is an error.
+ */
+bool ProcessorHostFunctionSet(Processor* processor, size_t functionNum, 
+                              hostFunction_t function, void* context);
+
+
+/**
+ * Push value to operand stack of processor. Verification of program isn't valid after 
+ * push or pop, so the next runs are checked.
+ * 
+ * @return false if operand stack is full and can't grow.
+ */
+bool ProcessorPush(Processor* processor, instruction_t value);
+
+
+/**
+ * Pop value from operand stack of processor.
+ * 
+ * @return false if operand stack is empty.
+ */
+bool ProcessorPop(Processor* processor, instruction_t* valueBuffer);
+
+
+/**
+ * @return false if cellNum is out of RAM.
+ */
+bool ProcessorRamGet(Processor* processor, size_t cellNum, memoryCell_t* valueBuffer);
+
+
+/**
+ * @return false if cellNum is out of RAM.
+ */
+bool ProcessorRamSet(Processor* processor, size_t cellNum, memoryCell_t value);
 
 
 //--------------------------------------------------------------------------------------------------
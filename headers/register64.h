@@ -37,6 +37,8 @@ struct Registers64
 };
 #undef DEF_REGISTER_
 
+const size_t REGISTER_COUNT = sizeof(Registers64) / sizeof(register64_t);
+
 
 //--------------------------------------------------------------------------------------------------
 
@@ -0,0 +1,95 @@
+/**
+ * @file
+ * This header provides you .asm source which is mapped from file and lexing functions
+ * for it. There is '\0' after the source and a page of zeros after it, so lexer reads
+ * 32 bytes at once by AVX2 without checks of the end. Pages which lexer has passed
+ * are dropped by window, so source of any size is assembled in bounded memory.
+ */
+
+#ifndef SOURCE_TEXT_H
+#define SOURCE_TEXT_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Passed source is dropped from memory by windows of this size.
+ */
+const size_t SOURCE_WINDOW_SIZE = 64 * 1024 * 1024;
+
+
+/**
+ * Source or its part. Part has no '\0' at the end, it is ended by size. Part doesn't own
+ * memory, source isn't unmapped when part is closed.
+ */
+struct SourceText
+{
+    const char* text;               /**< Source and '\0' after it.                       */
+    size_t      size;
+    void*       reserved;           /**< Mapped source and zeros after it, NULL in part. */
+    size_t      reservedSize;
+    size_t      releasedSize;       /**< Source before it is dropped from memory.        */
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool SourceTextOpen(SourceText* source, const char* fileName);
+
+
+void SourceTextClose(SourceText* source);
+
+
+/**
+ * Split source to at most maxPartCount parts of close sizes. Every part but the first one
+ * starts at line which starts with a word, so spaces and comments don't cross parts.
+ *
+ * @return number of parts, it is less if there are no such lines.
+ */
+size_t SourceTextSplit(const SourceText* source, SourceText* parts, size_t maxPartCount);
+
+
+/**
+ * Drop pages of source before cursor if they make a whole window.
+ * Source before cursor mustn't be read after it.
+ */
+void SourceTextRelease(SourceText* source, const char* cursor);
+
+
+/**
+ * Skip spaces, tabs, newlines and comments from ';' to the end of line.
+ *
+ * @param text         Text of SourceText.
+ * @param newlineCount Skipped newlines are added to it.
+ *
+ * @return the first symbol which isn't skipped, it is '\0' at the end of source.
+ */
+const char* SourceSkipSpaces(const char* text, size_t* newlineCount);
+
+
+/**
+ * @return '\n' at the end of line or '\0' at the end of source.
+ */
+const char* SourceFindLineEnd(const char* text);
+
+
+/**
+ * Word ends by space, tab, newline, ';' or '\0'.
+ *
+ * @return length of word or maxLength + 1 if word is longer.
+ */
+size_t SourceGetWordLength(const char* text, size_t maxLength);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // SOURCE_TEXT_H
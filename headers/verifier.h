@@ -0,0 +1,50 @@
+/**
+ * @file
+ * This header provides you a verifier of decoded code which runs once at program load.
+ * Jump targets, operand words and register indexes are checked by DecodedCodeInit(), 
+ * verifier proves the rest what lets decoded dispatch and JIT execute program without 
+ * run time checks. Other dispatch modes keep checks whether program is verified or not.
+ */
+
+#ifndef VERIFIER_H
+#define VERIFIER_H
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#include <stddef.h>
+
+#include "decodedCode.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Prove statically that:
+ * - every reachable instruction has the same operand stack depth on every path,
+ * - operand stack is never popped when it is empty and never has more than 
+ *   operandStackCapacity elements, calls included,
+ * - constant RAM cells are in RAM.
+ * 
+ * Every CALL target is verified as function: its RETs must leave the same depth.
+ * Recursion is proved only if it doesn't grow operand stack.
+ * 
+ * @param decodedCode    Code made by DecodedCodeInit() and not fused yet.
+ * @param ramSize        Cells of RAM which program is executed with.
+ * @param maxDepthBuffer Maximal depth of operand stack, it is set if program is proved,
+ *                       so stack is allocated for it.
+ * 
+ * @return true if program is proved,
+ * @return false if it isn't. It doesn't mean that program is wrong, so it is 
+ *         executed with checks then. Reason is printed to logs/log.txt .
+ */
+bool DecodedCodeVerify(DecodedCode* decodedCode, size_t operandStackCapacity, size_t ramSize,
+                       size_t* maxDepthBuffer);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#endif // VERIFIER_H
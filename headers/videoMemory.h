@@ -11,9 +11,6 @@
 //--------------------------------------------------------------------------------------------------
 
 
-const size_t VERTICAL_SIZE   = 7;
-const size_t HORIZONTAL_SIZE = VERTICAL_SIZE * 2;
-
 typedef memoryCell_t pixelColor_t;
 const pixelColor_t PIXEL_COLOR_WHITE  = 'W';
 const pixelColor_t PIXEL_COLOR_YELLOW = 'Y';
@@ -46,16 +43,17 @@ struct Position
 struct VideoMemory
 {
     Pixel* pixelArray;
+    size_t width;
+    size_t height;
 };
 
 
 //--------------------------------------------------------------------------------------------------
 
 
-bool VideoMemoryInit(VideoMemory* videoMemory);
+bool VideoMemoryInit(VideoMemory* videoMemory, size_t width, size_t height);
 void VideoMemoryDelete(VideoMemory* videoMemory);
 
-void VideoMemoryDraw(VideoMemory* videoMemory);
 bool VideoMemorySetColor(VideoMemory* videoMemory, Position position, pixelColor_t color);
 bool VideoMemorySetSymbol(VideoMemory* videoMemory, Position position, char symbol);
 void VideoMemoryReset(VideoMemory* videoMemory);
@@ -1,27 +1,136 @@
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/mman.h>
 
 #include "RAM.h"
 #include "videoMemory.h"
+#include "frameRenderer.h"
 #include "logPrinter.h"
 
 
 //--------------------------------------------------------------------------------------------------
 
 
+/**
+ * Pages whose residence is asked by one system call.
+ */
+static const size_t RAM_RESIDENCE_CHUNK_PAGE_COUNT = 4096;
 
-bool RamInit(RAM* ram)
+/**
+ * Cells which are masked in guarded RAM, guard pages take only address space,
+ * so small RAM traps cells far out of it instead of their wrap.
+ */
+static const size_t RAM_GUARDED_MIN_CELL_COUNT = 1 << 24;
+
+
+/**
+ * Guarded RAM whose faults are caught in this thread.
+ */
+struct RamFaultCatcher
 {
-    if (sizeof(Pixel) * VERTICAL_SIZE * HORIZONTAL_SIZE > RAM_CAPACITY * sizeof(memoryCell_t))
+    RAM*        ram;
+    sigjmp_buf* faultJump;
+};
+
+
+static thread_local RamFaultCatcher faultCatcher = {};
+
+static struct sigaction previousFaultAction = {};
+static pthread_once_t   faultHandlerOnce    = PTHREAD_ONCE_INIT;
+static bool             isFaultHandlerSet   = false;
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool RamSnapshotMake(RAM* ram);
+
+
+static void RamPagesCopy(RAM* source, RAM* destination);
+
+
+static bool PageIsZero(const char* page, size_t pageSize);
+
+
+static bool RamMap(RAM* ram, int fd);
+
+
+static char* RamGetMapped(RAM* ram);
+
+
+static void RamFaultHandlerSet();
+
+
+static void RamFaultHandle(int signalNum, siginfo_t* signalInfo, void* context);
+
+
+static VideoMemory RamGetVideoMemory(RAM* ram);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+
+bool RamInit(RAM* ram, const MemoryLayout* layout, bool isGuarded)
+{
+    *ram = {
+        .memory       = NULL,
+        .size         = layout->ramSize,
+        .screenWidth  = layout->screenWidth,
+        .screenHeight = layout->screenHeight,
+        .mappedSize   = 0,
+        .reservedSize = 0,
+        .mask         = 0,
+        .faultCellNum = 0,
+        .snapshotFd   = -1,
+        .isChanged    = true,
+    };
+
+    // Guarded RAM reserves up to twice more memory and a page.
+    if (layout->ramSize > SIZE_MAX / sizeof(memoryCell_t) / 4)
+    {
+        LOG_PRINT(ERROR, "RAM of %zu cells is too big.\n", layout->ramSize);
+        return false;
+    }
+
+    // Cells of screen are counted by division, so it can't overflow.
+    if (layout->screenWidth == 0 || layout->screenHeight == 0 ||
+        layout->ramSize * sizeof(memoryCell_t) / sizeof(Pixel) / layout->screenWidth < 
+                                                                        layout->screenHeight)
     {
         LOG_PRINT(ERROR, "RAM don't have enough memory to contain video memory.\n");
         return false;
     }
-    
-    ram->memory = (memoryCell_t*) calloc(RAM_CAPACITY, sizeof(memoryCell_t));
-    if (ram->memory == NULL)
+
+    const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+
+    const size_t ramByteCount = layout->ramSize * sizeof(memoryCell_t);
+
+    ram->mappedSize   = (ramByteCount + pageSize - 1) / pageSize * pageSize;
+    ram->reservedSize = ram->mappedSize;
+    if (isGuarded)
+    {
+        size_t cellCount = RAM_GUARDED_MIN_CELL_COUNT;
+        while (cellCount <= layout->ramSize)
+            cellCount *= 2;
+
+        // Memory starts at the same offset in the first page as it ends before guard pages.
+        ram->mask         = cellCount - 1;
+        ram->reservedSize = (ram->mappedSize - ramByteCount + cellCount * sizeof(memoryCell_t) + 
+                             pageSize - 1) / pageSize * pageSize;
+    }
+
+    if (!RamMap(ram, -1))
+    {
+        LOG_PRINT(ERROR, "Can't map RAM of %zu cells.\n", layout->ramSize);
         return false;
+    }
 
-    VideoMemoryReset((VideoMemory*) &ram->memory);
+    VideoMemory videoMemory = RamGetVideoMemory(ram);
+    VideoMemoryReset(&videoMemory);
 
     return true;
 }
@@ -29,14 +138,27 @@ bool RamInit(RAM* ram)
 
 void RamDelete(RAM* ram)
 {
-    free(ram->memory);
-    ram->memory = NULL;
+    // Snapshot exists only if memory is mapped.
+    if (ram->memory == NULL)
+        return;
+
+    munmap(RamGetMapped(ram), ram->reservedSize);
+
+    if (ram->snapshotFd != -1)
+        close(ram->snapshotFd);
+
+    ram->memory       = NULL;
+    ram->size         = 0;
+    ram->mappedSize   = 0;
+    ram->reservedSize = 0;
+    ram->mask         = 0;
+    ram->snapshotFd   = -1;
 }
 
 
 bool RamGetValue(RAM* ram, size_t cellNum, memoryCell_t* valueBuffer)
 {
-    if (cellNum >= RAM_CAPACITY)
+    if (cellNum >= ram->size)
         return false;
 
     *valueBuffer = ram->memory[cellNum];
@@ -46,7 +168,7 @@ bool RamGetValue(RAM* ram, size_t cellNum, memoryCell_t* valueBuffer)
 
 bool RamCellSet(RAM* ram, size_t cellNum, memoryCell_t value)
 {
-    if (cellNum >= RAM_CAPACITY)
+    if (cellNum >= ram->size)
         return false;
 
     ram->memory[cellNum] = value;
@@ -54,8 +176,311 @@ bool RamCellSet(RAM* ram, size_t cellNum, memoryCell_t value)
 }
 
 
-void RamScreenDraw(RAM* ram)
+size_t RamGetResidentPageCount(RAM* ram)
+{
+    if (ram->memory == NULL)
+        return 0;
+
+    const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    size_t       residentCount = 0;
+
+    unsigned char pageStates[RAM_RESIDENCE_CHUNK_PAGE_COUNT] = {};
+    for (size_t offset = 0; offset < ram->mappedSize; 
+                            offset += RAM_RESIDENCE_CHUNK_PAGE_COUNT * pageSize)
+    {
+        size_t chunkPageCount = (ram->mappedSize - offset) / pageSize;
+        if (chunkPageCount > RAM_RESIDENCE_CHUNK_PAGE_COUNT)
+            chunkPageCount = RAM_RESIDENCE_CHUNK_PAGE_COUNT;
+
+        if (mincore(RamGetMapped(ram) + offset, chunkPageCount * pageSize, pageStates) != 0)
+            return 0;
+
+        for (size_t pageNum = 0; pageNum < chunkPageCount; pageNum++)
+            residentCount += pageStates[pageNum] & 1;
+    }
+
+    return residentCount;
+}
+
+
+bool RamScreenDraw(RAM* ram, FrameRenderer* renderer)
 {
     // ColoredPrintf(GREEN, "ram->memory = %p\n", ram->memory);
-    VideoMemoryDraw((VideoMemory*) &ram->memory);
+    VideoMemory videoMemory = RamGetVideoMemory(ram);
+    return FrameRendererDraw(renderer, &videoMemory);
+}
+
+
+/**
+ * Source and clone map the same snapshot file privately, so kernel copies page 
+ * only when it is written by one of them. If there are no memory files, memory is copied.
+ */
+bool RamClone(RAM* source, RAM* clone)
+{
+    *clone = {
+        .memory       = NULL,
+        .size         = source->size,
+        .screenWidth  = source->screenWidth,
+        .screenHeight = source->screenHeight,
+        .mappedSize   = source->mappedSize,
+        .reservedSize = source->reservedSize,
+        .mask         = source->mask,
+        .faultCellNum = 0,
+        .snapshotFd   = -1,
+        .isChanged    = false,
+    };
+
+    if (source->isChanged && !RamSnapshotMake(source))
+    {
+        if (!RamMap(clone, -1))
+            return false;
+
+        RamPagesCopy(source, clone);
+        clone->isChanged = true;
+        return true;
+    }
+
+    clone->snapshotFd = dup(source->snapshotFd);
+    if (clone->snapshotFd == -1)
+        return false;
+
+    if (!RamMap(clone, clone->snapshotFd))
+    {
+        close(clone->snapshotFd);
+        clone->snapshotFd = -1;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool RamFaultCatch(RAM* ram, sigjmp_buf* faultJump)
+{
+    pthread_once(&faultHandlerOnce, RamFaultHandlerSet);
+    if (!isFaultHandlerSet)
+        return false;
+
+    faultCatcher = {
+        .ram       = ram,
+        .faultJump = faultJump,
+    };
+    return true;
+}
+
+
+void RamFaultRelease()
+{
+    faultCatcher = {};
+}
+
+
+void MemoryLayoutChoose(MemoryLayout* layout, const MemoryLayout* programLayout)
+{
+    if (programLayout != NULL)
+    {
+        if (layout->ramSize == 0)
+            layout->ramSize = programLayout->ramSize;
+        if (layout->screenWidth == 0)
+            layout->screenWidth = programLayout->screenWidth;
+        if (layout->screenHeight == 0)
+            layout->screenHeight = programLayout->screenHeight;
+    }
+
+    if (layout->ramSize == 0)
+        layout->ramSize = RAM_DEFAULT_SIZE;
+    if (layout->screenWidth == 0)
+        layout->screenWidth = SCREEN_DEFAULT_WIDTH;
+    if (layout->screenHeight == 0)
+        layout->screenHeight = SCREEN_DEFAULT_HEIGHT;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Write memory to new file and map it privately instead of memory at the same address.
+ * File has holes instead of zero pages, so sparse RAM has sparse snapshot.
+ */
+static bool RamSnapshotMake(RAM* ram)
+{
+#ifdef __linux__
+    int snapshotFd = memfd_create("RAM snapshot", MFD_CLOEXEC);
+    if (snapshotFd == -1)
+        return false;
+
+    if (ftruncate(snapshotFd, (off_t) ram->mappedSize) != 0)
+    {
+        close(snapshotFd);
+        return false;
+    }
+
+    const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < ram->mappedSize; offset += pageSize)
+    {
+        const char* page = RamGetMapped(ram) + offset;
+        if (PageIsZero(page, pageSize))
+            continue;
+
+        size_t writtenSize = 0;
+        while (writtenSize < pageSize)
+        {
+            ssize_t writeResult = pwrite(snapshotFd, page + writtenSize, pageSize - writtenSize,
+                                         (off_t) (offset + writtenSize));
+            if (writeResult <= 0)
+            {
+                close(snapshotFd);
+                return false;
+            }
+
+            writtenSize += (size_t) writeResult;
+        }
+    }
+
+    if (mmap(RamGetMapped(ram), ram->mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+             snapshotFd, 0) == MAP_FAILED)
+    {
+        close(snapshotFd);
+        return false;
+    }
+
+    if (ram->snapshotFd != -1)
+        close(ram->snapshotFd);
+
+    ram->snapshotFd = snapshotFd;
+    ram->isChanged  = false;
+    return true;
+#else
+    (void) ram;
+    return false;
+#endif
+}
+
+
+/**
+ * Copy pages which aren't zero to new anonymous memory of the same size, 
+ * so zero pages of destination stay unallocated.
+ */
+static void RamPagesCopy(RAM* source, RAM* destination)
+{
+    const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+    for (size_t offset = 0; offset < source->mappedSize; offset += pageSize)
+    {
+        const char* page = RamGetMapped(source) + offset;
+        if (!PageIsZero(page, pageSize))
+            memcpy(RamGetMapped(destination) + offset, page, pageSize);
+    }
+}
+
+
+/**
+ * Reading of untouched anonymous page maps shared zero page, it isn't allocated.
+ */
+static bool PageIsZero(const char* page, size_t pageSize)
+{
+    const uint64_t* words = (const uint64_t*) page;
+    for (size_t wordNum = 0; wordNum < pageSize / sizeof(uint64_t); wordNum++)
+        if (words[wordNum] != 0)
+            return false;
+
+    return true;
+}
+
+
+/**
+ * Reserve address space of RAM, map its readable pages and set memory. 
+ * Memory isn't reserved in swap, so pages are allocated only when they are written.
+ *
+ * @param fd File which is mapped privately or -1 for anonymous memory.
+ */
+static bool RamMap(RAM* ram, int fd)
+{
+    const int flags = (fd == -1) ? MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE : 
+                                   MAP_PRIVATE | MAP_NORESERVE;
+
+    void* reserved = mmap(NULL, ram->reservedSize, PROT_NONE, 
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reserved == MAP_FAILED)
+        return false;
+
+    if (mmap(reserved, ram->mappedSize, PROT_READ | PROT_WRITE, flags | MAP_FIXED, 
+             fd, 0) == MAP_FAILED)
+    {
+        munmap(reserved, ram->reservedSize);
+        return false;
+    }
+
+    const size_t memoryOffset = (ram->mask != 0) ? 
+                                    ram->mappedSize - ram->size * sizeof(memoryCell_t) : 0;
+    ram->memory = (memoryCell_t*) ((char*) reserved + memoryOffset);
+    return true;
+}
+
+
+/**
+ * @return the first readable page, memory of guarded RAM is inside it.
+ */
+static char* RamGetMapped(RAM* ram)
+{
+    const uintptr_t pageSize = (uintptr_t) sysconf(_SC_PAGESIZE);
+    return (char*) ((uintptr_t) ram->memory & ~(pageSize - 1));
+}
+
+
+/**
+ * Handler is set once for the whole process, faults are caught only by threads 
+ * which call RamFaultCatch().
+ */
+static void RamFaultHandlerSet()
+{
+    struct sigaction faultAction = {};
+    faultAction.sa_sigaction = RamFaultHandle;
+    faultAction.sa_flags     = SA_SIGINFO;
+    sigemptyset(&faultAction.sa_mask);
+
+    isFaultHandlerSet = sigaction(SIGSEGV, &faultAction, &previousFaultAction) == 0;
+}
+
+
+static void RamFaultHandle(int signalNum, siginfo_t* signalInfo, void* context)
+{
+    // Masked cells are the only accesses which can fault in guarded RAM.
+    RAM*        ram     = faultCatcher.ram;
+    const char* address = (const char*) signalInfo->si_addr;
+    if (ram != NULL && address >= (const char*) ram->memory && 
+                       address <  (const char*) (ram->memory + ram->mask + 1))
+    {
+        ram->faultCellNum = (size_t) (address - (const char*) ram->memory) / sizeof(memoryCell_t);
+        siglongjmp(*faultCatcher.faultJump, 1);
+    }
+
+    // Fault isn't in guarded RAM, so it goes to the previous handler and this one stays set.
+    if ((previousFaultAction.sa_flags & SA_SIGINFO) != 0)
+    {
+        previousFaultAction.sa_sigaction(signalNum, signalInfo, context);
+        return;
+    }
+
+    if (previousFaultAction.sa_handler != SIG_DFL && previousFaultAction.sa_handler != SIG_IGN)
+    {
+        previousFaultAction.sa_handler(signalNum);
+        return;
+    }
+
+    // Default action kills process, so fault is repeated without handler.
+    signal(SIGSEGV, SIG_DFL);
+}
+
+
+/**
+ * Screen is at the beginning of RAM.
+ */
+static VideoMemory RamGetVideoMemory(RAM* ram)
+{
+    return {
+        .pixelArray = (Pixel*) ram->memory,
+        .width      = ram->screenWidth,
+        .height     = ram->screenHeight,
+    };
 }
@@ -2,13 +2,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "assembler.h"
 #include "virtualMachine.h"
 #include "machineCode.h"
 #include "labelArray.h"
+#include "mnemonics.h"
 #include "logPrinter.h"
 #include "fileProcessor.h"
+#include "sourceText.h"
 
 
 //--------------------------------------------------------------------------------------------------
@@ -30,17 +34,67 @@ typedef enum COMMAND_STATUS cmdStatus_t;
 //--------------------------------------------------------------------------------------------------
 
 
+/**
+ * Jump to label which isn't defined yet. Its target is written after the last command.
+ */
+struct LabelFixup
+{
+    size_t nameOffset;              /**< Name in fixupNames of Assembler.   */
+    size_t nameLength;
+    size_t instructionNum;          /**< Placeholder of jump target.        */
+    size_t lineNum;
+};
+
+
 struct Assembler
 {
-    char* assemblyCode;
-    char* firstAssemblyCode;
+    const char* assemblyCode;
+    SourceText source;
     MachineCode machineCode;
     LabelArray labelArray;
     size_t lineNum;
+    LabelFixup* fixups;
+    size_t fixupCount;
+    size_t fixupCapacity;
+    char* fixupNames;               /**< Names of fixups with '\0' after every one. */
+    size_t fixupNamesSize;
+    size_t fixupNamesCapacity;
+    bool isPart;                    /**< Part of source, errors aren't printed and
+                                         every jump is resolved after all parts.    */
+};
+
+
+/**
+ * Part of source which is assembled and linked by its own thread. Lines and instructions 
+ * of part start from the beginning, they are shifted when part is written to code of all. 
+ * Labels of all parts are split between parts by hash, so every part adds its share of them 
+ * and nothing is locked.
+ */
+struct AssemblerPart
+{
+    pthread_t      thread;
+    Assembler      assembler;
+    bool           isAssembled;         /**< There were no errors in part.              */
+    size_t         instructionShift;    /**< Instructions of parts before it.           */
+    size_t         lineTableShift;      /**< Line table of parts before it.             */
+    size_t         lineShift;           /**< Lines of source before it.                 */
+    size_t         partNum;
+    LabelArray     labelArray;          /**< Labels of all parts which hash is of part. */
+    AssemblerPart* parts;               /**< All parts.                                 */
+    size_t         partCount;
+    MachineCode*   machineCode;         /**< Code of all parts.                         */
 };
 
 const size_t FIRST_LINE = 1;
 
+static const size_t FIXUPS_MIN_CAPACITY      = 16;
+static const size_t FIXUP_NAMES_MIN_CAPACITY = 1024;
+
+/**
+ * Smaller source is assembled by one thread, starting of threads isn't worth it.
+ */
+static const size_t PART_MIN_SIZE = 1024 * 1024;
+
 
 //--------------------------------------------------------------------------------------------------
 
@@ -48,11 +102,41 @@ const size_t FIRST_LINE = 1;
 static bool AssembleCmds(Assembler* assembler);
 
 
+static bool AssembleParts(Assembler* assembler);
+
+
+static bool AssemblerPartsRun(AssemblerPart* parts, size_t partCount, void* (*partRun)(void*));
+
+
+static void* AssemblerPartAssemble(void* partPtr);
+
+
+static bool AssemblerPartsPlace(AssemblerPart* parts, size_t partCount, MachineCode* machineCode);
+
+
+static void* AssemblerPartLabelsAdd(void* partPtr);
+
+
+static void* AssemblerPartLink(void* partPtr);
+
+
+static size_t LabelGetPartNum(uint64_t labelHash, size_t partCount);
+
+
+static size_t GetCoreCount();
+
+
+static bool LabelFixupAdd(Assembler* assembler, const char* labelName, size_t nameLength);
+
+
+static bool LabelFixupsResolve(Assembler* assembler);
+
+
 static cmdStatus_t GetNextWord(Assembler* assembler, char* wordBuffer);
+static cmdStatus_t GetNextLongWord(Assembler* assembler, const char** wordBuffer, 
+                                   size_t* lengthBuffer);
 
 
-static bool IsSpace(char symbol);
-static bool IsCommentSymbol(char symbol);
 static void SkipSpaces(Assembler* assembler);
 static void SkipComments(Assembler* assembler);
 
@@ -66,19 +150,26 @@ static cmdStatus_t JumpGetAndWriteAddress(Assembler* assembler);
 static cmdStatus_t CmdNextGetAndWrite(Assembler* assembler);
 
 
+static cmdStatus_t DirectiveGetAndApply(Assembler* assembler, const char* directiveName);
+
+
+static cmdStatus_t DirectiveGetSize(Assembler* assembler, size_t* sizeBuffer);
+
+
 static bool AssemblerInit(Assembler* assembler, const char* fileToAssembleName, Place place);
 
 #define ASSEMBLER_INIT(assembler, fileToAssemble) \
     AssemblerInit(assembler, fileToAssemble, GET_PLACE())
 
-static void AssemblerCodeRewind(Assembler* assembler);
+static bool AssemblerPartInit(Assembler* assembler, const SourceText* source);
+
 static void AssemblerDelete(Assembler* assembler);
 
 
 //--------------------------------------------------------------------------------------------------
 
 
-bool Assemble(const char* fileName) 
+bool Assemble(const char* fileName, bool isCompact) 
 {
     if (fileName == NULL)
     {
@@ -98,18 +189,24 @@ bool Assemble(const char* fileName)
         return false;
     }
 
-    AssembleCmds(&assembler);
-    bool assemblingResult = AssembleCmds(&assembler);
+    // Errors of parts are found again and printed by one thread, it knows their lines.
+    bool assemblingResult = AssembleParts(&assembler) ||
+                            (AssembleCmds(&assembler) && LabelFixupsResolve(&assembler));
+    if (assembler.machineCode.isOverflowed)
+    {
+        ColoredPrintf(RED, "Error: there is no memory for machine code.\n");
+        assemblingResult = false;
+    }
 
     char* assembledFileName = NULL;
-    if (!FileNameChangeExtension((char*) fileName, &assembledFileName, ".asm",
-                                                                    MACHINE_CODE_FILE_EXTENSION))
+    if (!FileNameChangeExtension(fileName, &assembledFileName, ".asm",
+                                                            MACHINE_CODE_FILE_EXTENSION))
     {
         ColoredPrintf(RED, "Can't set assembledFileName.\n");
         AssemblerDelete(&assembler);
         return false;
     }
-    MachineCodeWriteToFile(&assembler.machineCode, assembledFileName);
+    MachineCodeWriteToFile(&assembler.machineCode, assembledFileName, isCompact);
 
     AssemblerDelete(&assembler);
     free(assembledFileName);
@@ -135,7 +232,7 @@ static bool AssemblerInit(Assembler* assembler, const char* fileToAssembleName,
         return false;
     }
 
-    if (!FileGetContent(fileToAssembleName, &assembler->assemblyCode))
+    if (!SourceTextOpen(&assembler->source, fileToAssembleName))
     {
         LOG_PRINT_WITH_PLACE(ERROR, place, "Assembler error: can't read content of %s.\n", 
                              fileToAssembleName);
@@ -144,39 +241,63 @@ static bool AssemblerInit(Assembler* assembler, const char* fileToAssembleName,
         return false;
     }
     
-    assembler->firstAssemblyCode = assembler->assemblyCode;
+    assembler->assemblyCode = assembler->source.text;
     assembler->lineNum = FIRST_LINE;
     return true;
 }
 
 
-static void AssemblerCodeRewind(Assembler* assembler)
+static bool AssemblerPartInit(Assembler* assembler, const SourceText* source)
 {
-    assembler->lineNum = FIRST_LINE;
-    MachineCodeJump(&assembler->machineCode, JUMP_ABSOLUTE, FIRST_INSTRUCTION_NUM);
-    assembler->assemblyCode = assembler->firstAssemblyCode;
+    *assembler = {};
+    if (!MachineCodeInit(&assembler->machineCode))
+        return false;
+
+    if (!LABEL_ARRAY_CREATE(&assembler->labelArray))
+    {
+        MachineCodeDelete(&assembler->machineCode);
+        return false;
+    }
+
+    assembler->source       = *source;
+    assembler->assemblyCode = source->text;
+    assembler->lineNum      = FIRST_LINE;
+    assembler->isPart       = true;
+    return true;
 }
 
 
 static void AssemblerDelete(Assembler* assembler)
 {
-    free(assembler->firstAssemblyCode);
-    assembler->firstAssemblyCode = NULL;
-    assembler->assemblyCode      = NULL;
+    SourceTextClose(&assembler->source);
+    assembler->assemblyCode = NULL;
 
     MachineCodeDelete(&assembler->machineCode);
     LabelArrayDelete(&assembler->labelArray);
     assembler->lineNum = 0;
+
+    free(assembler->fixups);
+    assembler->fixups        = NULL;
+    assembler->fixupCount    = 0;
+    assembler->fixupCapacity = 0;
+
+    free(assembler->fixupNames);
+    assembler->fixupNames         = NULL;
+    assembler->fixupNamesSize     = 0;
+    assembler->fixupNamesCapacity = 0;
 }
 
 
+/**
+ * Code is assembled in one pass, jumps to labels below are fixed by LabelFixupsResolve().
+ */
 static bool AssembleCmds(Assembler* assembler)
 {
-    AssemblerCodeRewind(assembler);
     cmdStatus_t cmdStatus = CMD_WRONG;
 
     for (;;)
     {
+        SourceTextRelease(&assembler->source, assembler->assemblyCode);
         cmdStatus = CmdNextGetAndWrite(assembler);
 
         if (cmdStatus == CMD_NO)
@@ -190,100 +311,370 @@ static bool AssembleCmds(Assembler* assembler)
 }
 
 
-static cmdStatus_t GetNextWord(Assembler* assembler, char* wordBuffer)
+/**
+ * Source is split by lines to parts for every core. Parts are assembled at once,
+ * then labels of all parts are collected, jumps are resolved and parts are written
+ * to one code at once too.
+ *
+ * @return false if source is small or part has an error, nothing is written then.
+ */
+static bool AssembleParts(Assembler* assembler)
 {
-    SkipSpaces(assembler);
+    size_t maxPartCount = GetCoreCount();
+    if (maxPartCount > assembler->source.size / PART_MIN_SIZE)
+        maxPartCount = assembler->source.size / PART_MIN_SIZE;
+
+    if (maxPartCount < 2)
+        return false;
+
+    SourceText*    sources = (SourceText*)    calloc(maxPartCount, sizeof(SourceText));
+    AssemblerPart* parts   = (AssemblerPart*) calloc(maxPartCount, sizeof(AssemblerPart));
+    if (sources == NULL || parts == NULL)
+    {
+        free(sources);
+        free(parts);
+        return false;
+    }
 
-    char nextChar = 0;
-    for (size_t charNum = 0; charNum < MAX_CMD_LENGTH; charNum++)
+    MachineCode  machineCode = {};
+    const size_t partCount   = SourceTextSplit(&assembler->source, sources, maxPartCount);
+    size_t       initedCount = 0;
+    for (; initedCount < partCount; initedCount++)
     {
-        // printf("contentPtr = %p\n", contentPtr);
-        // printf("content = %p\n", *contentPtr);
-        nextChar = assembler->assemblyCode[0];
-        if (nextChar == '\0')
+        AssemblerPart* part = parts + initedCount;
+        if (!AssemblerPartInit(&part->assembler, sources + initedCount))
+            break;
+
+        if (!LABEL_ARRAY_CREATE(&part->labelArray))
         {
-            if (charNum == 0)
-                return CMD_NO;
-            
+            AssemblerDelete(&part->assembler);
             break;
         }
 
-        if (IsSpace(nextChar) || IsCommentSymbol(nextChar))
-            break;
+        part->partNum     = initedCount;
+        part->parts       = parts;
+        part->partCount   = partCount;
+        part->machineCode = &machineCode;
+    }
+
+    const bool isAssembled = partCount > 1 && initedCount == partCount                   &&
+                             MachineCodeInit(&machineCode)                               &&
+                             AssemblerPartsRun(parts, partCount, AssemblerPartAssemble)  &&
+                             AssemblerPartsPlace(parts, partCount, &machineCode)         &&
+                             AssemblerPartsRun(parts, partCount, AssemblerPartLabelsAdd) &&
+                             AssemblerPartsRun(parts, partCount, AssemblerPartLink);
 
-        wordBuffer[charNum] = nextChar;
-        wordBuffer[charNum + 1] = '\0';
-        assembler->assemblyCode++;
+    if (isAssembled)
+    {
+        MachineCodeDelete(&assembler->machineCode);
+        assembler->machineCode = machineCode;
     }
+    else
+        MachineCodeDelete(&machineCode);
 
-    nextChar = assembler->assemblyCode[0];
-    if (nextChar != '\0' && !IsSpace(nextChar) && !IsCommentSymbol(nextChar))
+    for (size_t partNum = 0; partNum < initedCount; partNum++)
     {
-        // LOG_PRINT(INFO, "cmd = <%s>, nextChar = %d\n", cmdNameBuffer, nextChar);
-        return CMD_WRONG;
+        AssemblerDelete(&parts[partNum].assembler);
+        LabelArrayDelete(&parts[partNum].labelArray);
     }
-    // wordBuffer[MAX_CMD_LENGTH] = '\0';
 
-    return CMD_OK;
+    free(sources);
+    free(parts);
+    return isAssembled;
 }
 
 
-static bool IsSpace(char symbol)
+/**
+ * Every part is run by its own thread, parts which threads aren't started for 
+ * are run by this thread.
+ *
+ * @return true if every part is still assembled.
+ */
+static bool AssemblerPartsRun(AssemblerPart* parts, size_t partCount, void* (*partRun)(void*))
 {
-    if (symbol == ' ' || symbol == '\t' || symbol == '\n')
-        return true;
+    size_t startedCount = 1;
+    while (startedCount < partCount && 
+           pthread_create(&parts[startedCount].thread, NULL, partRun, parts + startedCount) == 0)
+        startedCount++;
+
+    partRun(parts);
+    for (size_t partNum = startedCount; partNum < partCount; partNum++)
+        partRun(parts + partNum);
 
-    return false;
+    for (size_t partNum = 1; partNum < startedCount; partNum++)
+        pthread_join(parts[partNum].thread, NULL);
+
+    for (size_t partNum = 0; partNum < partCount; partNum++)
+    {
+        if (!parts[partNum].isAssembled)
+            return false;
+    }
+
+    return true;
 }
 
 
-static bool IsCommentSymbol(char symbol)
+static void* AssemblerPartAssemble(void* partPtr)
 {
-    if (symbol == ';')
-        return true;
-    
-    return false;
+    AssemblerPart* part      = (AssemblerPart*) partPtr;
+    Assembler*     assembler = &part->assembler;
+
+    // Part which is stopped by '\0' before its end isn't assembled like whole source.
+    part->isAssembled = AssembleCmds(assembler) && !assembler->machineCode.isOverflowed &&
+                        assembler->assemblyCode >= assembler->source.text + assembler->source.size;
+    return NULL;
 }
 
 
-static void SkipSpaces(Assembler* assembler)
+/**
+ * Parts are placed one after another in code of all parts. Directive of later part overrides.
+ */
+static bool AssemblerPartsPlace(AssemblerPart* parts, size_t partCount, MachineCode* machineCode)
 {
-    int nextChar = 0;
-    for (;;)
+    size_t instructionCount = 0;
+    size_t lineTableCount   = 0;
+    size_t lineCount        = 0;
+    for (size_t partNum = 0; partNum < partCount; partNum++)
     {
-        nextChar = assembler->assemblyCode[0];
-        
-        if (nextChar == '\0')
-            return;
-            
-        if (nextChar == '\n')
-            assembler->lineNum++;
-
-        if (!IsSpace((char) nextChar))
-            break;
+        AssemblerPart*     part         = parts + partNum;
+        const MachineCode* partCode     = &part->assembler.machineCode;
+        part->instructionShift = instructionCount;
+        part->lineTableShift   = lineTableCount;
+        part->lineShift        = lineCount;
+
+        instructionCount += partCode->instructionCount;
+        lineTableCount   += partCode->lineCount;
+        lineCount        += part->assembler.lineNum - FIRST_LINE;
 
-        assembler->assemblyCode++;
+        if (partCode->layout.ramSize != 0)
+            machineCode->layout.ramSize = partCode->layout.ramSize;
+
+        if (partCode->layout.screenWidth != 0)
+        {
+            machineCode->layout.screenWidth  = partCode->layout.screenWidth;
+            machineCode->layout.screenHeight = partCode->layout.screenHeight;
+        }
     }
+
+    return MachineCodeResize(machineCode, instructionCount, lineTableCount);
 }
 
 
-static void SkipComments(Assembler* assembler)
+/**
+ * Part adds labels of all parts which hash is of it. Label which is defined 
+ * in two parts is found here, because their hashes are the same.
+ */
+static void* AssemblerPartLabelsAdd(void* partPtr)
 {
-    int nextChar = assembler->assemblyCode[0];
-    if (nextChar == '\0')
-        return;
-
-    if (IsCommentSymbol((char) nextChar))
-        for (;;)
+    AssemblerPart* part = (AssemblerPart*) partPtr;
+    for (size_t partNum = 0; part->isAssembled && partNum < part->partCount; partNum++)
+    {
+        const AssemblerPart* labelPart  = part->parts + partNum;
+        const LabelArray*    labelArray = &labelPart->assembler.labelArray;
+        for (size_t labelNum = 0; labelNum < labelArray->capacity; labelNum++)
         {
-            assembler->assemblyCode++;
-            nextChar = assembler->assemblyCode[0];
-            if (nextChar == '\n')
+            const Label* label = labelArray->data + labelNum;
+            if (label->instructionNum == LABEL_POISON_NUM ||
+                LabelGetPartNum(label->hash, part->partCount) != part->partNum)
+                continue;
+
+            if (!LabelAdd(&part->labelArray, labelArray->names + label->nameOffset,
+                          label->nameLength, labelPart->instructionShift + label->instructionNum))
             {
-                assembler->lineNum++;
+                part->isAssembled = false;
                 break;
             }
         }
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Jumps of part are resolved, then part is written to code of all parts.
+ */
+static void* AssemblerPartLink(void* partPtr)
+{
+    AssemblerPart* part      = (AssemblerPart*) partPtr;
+    Assembler*     assembler = &part->assembler;
+    for (size_t fixupNum = 0; fixupNum < assembler->fixupCount; fixupNum++)
+    {
+        LabelFixup*    fixup     = assembler->fixups + fixupNum;
+        const char*    labelName = assembler->fixupNames + fixup->nameOffset;
+        const uint64_t labelHash = LabelNameGetHash(labelName, fixup->nameLength);
+        AssemblerPart* labelPart = part->parts + LabelGetPartNum(labelHash, part->partCount);
+
+        size_t instructionNum = LABEL_POISON_NUM;
+        if (!LabelFind(&labelPart->labelArray, labelName, fixup->nameLength, &instructionNum))
+        {
+            part->isAssembled = false;
+            return NULL;
+        }
+
+        assembler->machineCode.code[fixup->instructionNum] = (instruction_t) instructionNum;
+    }
+
+    MachineCodeWritePart(part->machineCode, &assembler->machineCode, part->instructionShift, 
+                         part->lineTableShift, part->lineShift);
+    return NULL;
+}
+
+
+/**
+ * Slot of label table is taken by the lower bits of hash, so part is taken by the upper ones.
+ */
+static size_t LabelGetPartNum(uint64_t labelHash, size_t partCount)
+{
+    return (labelHash >> 32) % partCount;
+}
+
+
+static size_t GetCoreCount()
+{
+    long coreCount = sysconf(_SC_NPROCESSORS_ONLN);
+    if (coreCount < 1)
+        return 1;
+
+    return (size_t) coreCount;
+}
+
+
+/**
+ * Name of label is copied to fixupNames, so it isn't read from source after it is released.
+ */
+static bool LabelFixupAdd(Assembler* assembler, const char* labelName, size_t nameLength)
+{
+    if (assembler->fixupCount == assembler->fixupCapacity)
+    {
+        const size_t newCapacity = (assembler->fixupCapacity == 0) ? 
+                                       FIXUPS_MIN_CAPACITY : 2 * assembler->fixupCapacity;
+        LabelFixup* newFixups = (LabelFixup*) realloc(assembler->fixups, 
+                                                      newCapacity * sizeof(LabelFixup));
+        if (newFixups == NULL)
+            return false;
+
+        assembler->fixups        = newFixups;
+        assembler->fixupCapacity = newCapacity;
+    }
+
+    const size_t newNamesSize = assembler->fixupNamesSize + nameLength + 1;
+    if (newNamesSize > assembler->fixupNamesCapacity)
+    {
+        size_t newCapacity = (assembler->fixupNamesCapacity == 0) ? 
+                                 FIXUP_NAMES_MIN_CAPACITY : assembler->fixupNamesCapacity;
+        while (newCapacity < newNamesSize)
+            newCapacity *= 2;
+
+        char* newNames = (char*) realloc(assembler->fixupNames, newCapacity);
+        if (newNames == NULL)
+            return false;
+
+        assembler->fixupNames         = newNames;
+        assembler->fixupNamesCapacity = newCapacity;
+    }
+
+    char* fixupName = assembler->fixupNames + assembler->fixupNamesSize;
+    memcpy(fixupName, labelName, nameLength);
+    fixupName[nameLength] = '\0';
+
+    assembler->fixups[assembler->fixupCount++] = {
+        .nameOffset     = assembler->fixupNamesSize,
+        .nameLength     = nameLength,
+        .instructionNum = MachineCodeGetInstructionNum(&assembler->machineCode),
+        .lineNum        = assembler->lineNum,
+    };
+    assembler->fixupNamesSize = newNamesSize;
+    return true;
+}
+
+
+/**
+ * Write targets of jumps to labels which were below them. Every undefined label is printed.
+ */
+static bool LabelFixupsResolve(Assembler* assembler)
+{
+    bool isResolved = true;
+    for (size_t fixupNum = 0; fixupNum < assembler->fixupCount; fixupNum++)
+    {
+        LabelFixup* fixup     = assembler->fixups + fixupNum;
+        const char* labelName = assembler->fixupNames + fixup->nameOffset;
+
+        size_t instructionNum = LABEL_POISON_NUM;
+        if (!LabelFind(&assembler->labelArray, labelName, fixup->nameLength, &instructionNum))
+        {
+            ColoredPrintf(RED, "Error in line %zu: label %s isn't defined.\n", 
+                               fixup->lineNum, labelName);
+            isResolved = false;
+            continue;
+        }
+
+        assembler->machineCode.code[fixup->instructionNum] = (instruction_t) instructionNum;
+    }
+
+    return isResolved;
+}
+
+
+/**
+ * Commands and arguments are read to wordBuffer of MAX_CMD_LENGTH + 1 chars.
+ */
+static cmdStatus_t GetNextWord(Assembler* assembler, char* wordBuffer)
+{
+    const char* word       = NULL;
+    size_t      wordLength = 0;
+    cmdStatus_t wordStatus = GetNextLongWord(assembler, &word, &wordLength);
+    if (wordStatus != CMD_OK)
+        return wordStatus;
+
+    if (wordLength > MAX_CMD_LENGTH)
+        return CMD_WRONG;
+
+    memcpy(wordBuffer, word, wordLength);
+    wordBuffer[wordLength] = '\0';
+
+    return CMD_OK;
+}
+
+
+/**
+ * Labels are words of any length, so word is left in source and it has no '\0' after it.
+ * It mustn't be read after the next SourceTextRelease().
+ */
+static cmdStatus_t GetNextLongWord(Assembler* assembler, const char** wordBuffer, 
+                                   size_t* lengthBuffer)
+{
+    SkipSpaces(assembler);
+    const char* sourceEnd = assembler->source.text + assembler->source.size;
+    if (assembler->assemblyCode >= sourceEnd || assembler->assemblyCode[0] == '\0')
+        return CMD_NO;
+
+    const size_t leftSize = (size_t) (sourceEnd - assembler->assemblyCode);
+
+    *wordBuffer   = assembler->assemblyCode;
+    *lengthBuffer = SourceGetWordLength(assembler->assemblyCode, leftSize);
+    assembler->assemblyCode += *lengthBuffer;
+
+    return CMD_OK;
+}
+
+
+/**
+ * Comments are skipped too, newlines are counted.
+ */
+static void SkipSpaces(Assembler* assembler)
+{
+    assembler->assemblyCode = SourceSkipSpaces(assembler->assemblyCode, &assembler->lineNum);
+}
+
+
+/**
+ * Newline at the end of comment is left for SkipSpaces(), it counts the line.
+ */
+static void SkipComments(Assembler* assembler)
+{
+    if (assembler->assemblyCode[0] == ';')
+        assembler->assemblyCode = SourceFindLineEnd(assembler->assemblyCode);
 }
 
 
@@ -330,21 +721,25 @@ static bool ConvertToInstruction(char* string, instruction_t* valueBuffer)
 
 static cmdStatus_t JumpGetAndWriteAddress(Assembler* assembler)
 {
-    char labelName[MAX_LABEL_NAME_LENGTH + 1] = {};
-    GetNextWord(assembler, labelName);
-    if (!LabelIs(labelName))
+    const char* labelName  = "";
+    size_t      nameLength = 0;
+    if (GetNextLongWord(assembler, &labelName, &nameLength) != CMD_OK || 
+        !LabelIs(labelName, nameLength))
     {
-        LOG_PRINT(ERROR, "LabelName = <%s>\n", labelName);
+        LOG_PRINT(ERROR, "LabelName = <%.*s>\n", (int) nameLength, labelName);
         return CMD_WRONG;
     }
     // LABEL_ARRAY_DUMP(&assembler->labelArray);
 
     size_t instructionNum = LABEL_POISON_NUM;
-    LabelFind(&assembler->labelArray, labelName, &instructionNum);
-    if (instructionNum == LABEL_POISON_NUM)
+    if (assembler->isPart || 
+        !LabelFind(&assembler->labelArray, labelName, nameLength, &instructionNum))
     {
-        MachineCodeAddInstruction(&assembler->machineCode, (instruction_t) LABEL_POISON_NUM);
-        LabelAdd(&assembler->labelArray, labelName, LABEL_DUMMY_NUM);
+        if (!LabelFixupAdd(assembler, labelName, nameLength) ||
+            MachineCodeAddInstruction(&assembler->machineCode, 
+                                      (instruction_t) LABEL_POISON_NUM) != CODE_OK)
+            return CMD_WRONG;
+
         return CMD_LABEL;
     }
 
@@ -355,41 +750,110 @@ static cmdStatus_t JumpGetAndWriteAddress(Assembler* assembler)
 
 
 #define DEF_CMD_(CMD_NAME, CMD_SET, ...)            \
-{                                                   \
-    if (strcmp(cmdName, GET_NAME(CMD_NAME)) == 0)   \
+    case CMD_NAME:                                  \
     {                                               \
         CMD_SET;                                    \
-    }                                               \
-}
+    }
 
 
 static cmdStatus_t CmdNextGetAndWrite(Assembler* assembler)
 {
+    const char* word       = NULL;
+    size_t      wordLength = 0;
+    if (GetNextLongWord(assembler, &word, &wordLength) == CMD_NO)
+        return CMD_NO;
+
+    if (LabelIs(word, wordLength))
+    {
+        size_t instructionNum = LABEL_POISON_NUM;
+        if (LabelFind(&assembler->labelArray, word, wordLength, &instructionNum))
+        {
+            if (!assembler->isPart)
+                ColoredPrintf(RED, "Error in line %zu: label %.*s is defined twice.\n", 
+                                   assembler->lineNum, (int) wordLength, word);
+            return CMD_WRONG;
+        }
+
+        instructionNum = MachineCodeGetInstructionNum(&assembler->machineCode);
+        if (!LabelAdd(&assembler->labelArray, word, wordLength, instructionNum))
+            return CMD_WRONG;
+
+        return CMD_LABEL;
+    }
+
+    if (wordLength > MAX_CMD_LENGTH)
+    {
+        if (!assembler->isPart)
+            ColoredPrintf(RED, "Error in line %zu: wrong command name!\n", assembler->lineNum);
+        return CMD_WRONG;
+    }
+
     char cmdName[MAX_CMD_LENGTH + 1] = {};
-    cmdStatus_t cmdStatus = GetNextWord(assembler, cmdName);
+    memcpy(cmdName, word, wordLength);
     // LOG_PRINT(INFO, "cmdName = <%s>.\n", cmdName);
 
-    if (cmdStatus == CMD_WRONG)
+    if (cmdName[0] == '.')
+        return DirectiveGetAndApply(assembler, cmdName);
+
+    if (!MachineCodeAddLine(&assembler->machineCode, assembler->lineNum))
+        return CMD_WRONG;
+
+    switch (CmdNameFromString(cmdName))
     {
-        ColoredPrintf(RED, "Error in line %zu: wrong command name!\n", assembler->lineNum);
-        // LOG_PRINT(ERROR, "cmd <%s> is wrong.\n", cmdName);
+    #include "commands.h"
+
+    case CMD_NAME_WRONG:
+    default:
+        if (!assembler->isPart)
+            ColoredPrintf(RED, "Error in line %zu: command %s doesn't exist.\n", 
+                                assembler->lineNum, cmdName);
         return CMD_WRONG;
     }
-    if (cmdStatus == CMD_NO)
-        return CMD_NO;
+}
+#undef DEF_CMD_
+
+
+/**
+ * Directives set memory layout of program, it is written to .vm file:
+ *  .ram N          RAM has N cells,
+ *  .screen W H     screen at the beginning of RAM has H rows of W pixels.
+ */
+static cmdStatus_t DirectiveGetAndApply(Assembler* assembler, const char* directiveName)
+{
+    MemoryLayout* layout = &assembler->machineCode.layout;
 
-    if (LabelIs(cmdName))
+    cmdStatus_t directiveStatus = CMD_WRONG;
+    if (strcmp(directiveName, ".ram") == 0)
+        directiveStatus = DirectiveGetSize(assembler, &layout->ramSize);
+    else if (strcmp(directiveName, ".screen") == 0)
     {
-        size_t instructionNum = MachineCodeGetInstructionNum(&assembler->machineCode);
-        LabelAddOrChangeInstructionNum(&assembler->labelArray, cmdName, instructionNum);
-        return CMD_LABEL;
+        directiveStatus = DirectiveGetSize(assembler, &layout->screenWidth);
+        if (directiveStatus == CMD_OK)
+            directiveStatus = DirectiveGetSize(assembler, &layout->screenHeight);
     }
 
-    #include "commands.h"
+    if (directiveStatus != CMD_OK)
+    {
+        if (!assembler->isPart)
+            ColoredPrintf(RED, "Error in line %zu: wrong directive %s.\n", 
+                               assembler->lineNum, directiveName);
+        return CMD_WRONG;
+    }
 
-    //else
-    ColoredPrintf(RED, "Error in line %zu: command %s doesn't exist.\n", 
-                        assembler->lineNum, cmdName);
-    return CMD_WRONG;
+    SkipSpaces(assembler);
+    SkipComments(assembler);
+    return CMD_OK;
+}
+
+
+static cmdStatus_t DirectiveGetSize(Assembler* assembler, size_t* sizeBuffer)
+{
+    char          argBuffer[MAX_CMD_LENGTH + 1] = {};
+    instruction_t size = 0;
+    if (GetNextWord(assembler, argBuffer) != CMD_OK || 
+        !ConvertToInstruction(argBuffer, &size) || size <= 0)
+        return CMD_WRONG;
+
+    *sizeBuffer = (size_t) size;
+    return CMD_OK;
 }
-#undef DEF_CMD_
@@ -0,0 +1,517 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "batch.h"
+#include "assembler.h"
+#include "fileProcessor.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Jobs of one thread. Owner takes them from the bottom, other threads steal from the top.
+ */
+struct BatchQueue
+{
+    size_t*         jobNums;
+    size_t          top;
+    size_t          bottom;
+    pthread_mutex_t mutex;
+};
+
+
+struct BatchWorker
+{
+    pthread_t     thread;
+    size_t        workerNum;
+    Batch*        batch;
+    BatchOptions* options;
+    BatchQueue*   queues;           /**< Queues of all workers.                         */
+    size_t        queueCount;
+
+    size_t        executedCount;
+    size_t        stolenCount;
+};
+
+
+static const size_t BATCH_MIN_CAPACITY = 16;
+
+static const char* const BATCH_COMMENT_PREFIX = "#";
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool BatchLineParse(Batch* batch, char* line, size_t lineNum);
+
+
+static bool BatchProgramFind(Batch* batch, const char* programName, size_t* programNumBuffer);
+
+
+static bool BatchProgramAdd(Batch* batch, const char* programName);
+
+
+static BatchJob* BatchJobAdd(Batch* batch, size_t programNum);
+
+
+static bool BatchJobInputAdd(BatchJob* job, instruction_t value);
+
+
+static void* BatchWorkerRun(void* workerPtr);
+
+
+static bool BatchWorkerTakeJob(BatchWorker* worker, size_t* jobNumBuffer);
+
+
+static bool BatchQueuePop(BatchQueue* queue, size_t* jobNumBuffer);
+
+
+static bool BatchQueueSteal(BatchQueue* queue, size_t* jobNumBuffer);
+
+
+static void BatchJobExecute(Batch* batch, BatchOptions* options, BatchJob* job);
+
+
+static const char* ProcessorStatusGetName(processorStatus_t status);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool BatchInitFromFile(Batch* batch, const char* fileName)
+{
+    *batch = {};
+
+    char* content = NULL;
+    if (!FileGetContent(fileName, &content))
+    {
+        ColoredPrintf(RED, "Can't read batch from %s.\n", fileName);
+        free(content);
+        return false;
+    }
+
+    char*  lineEnd = NULL;
+    size_t lineNum = 1;
+    for (char* line = strtok_r(content, "\n", &lineEnd); line != NULL;
+               line = strtok_r(NULL,    "\n", &lineEnd), lineNum++)
+    {
+        if (!BatchLineParse(batch, line, lineNum))
+        {
+            free(content);
+            BatchDelete(batch);
+            return false;
+        }
+    }
+
+    free(content);
+    return true;
+}
+
+
+void BatchDelete(Batch* batch)
+{
+    for (size_t programNum = 0; programNum < batch->programCount; programNum++)
+    {
+        free(batch->programs[programNum].name);
+        MachineCodeDelete(&batch->programs[programNum].machineCode);
+    }
+
+    for (size_t jobNum = 0; jobNum < batch->jobCount; jobNum++)
+    {
+        free(batch->jobs[jobNum].inputs);
+        free(batch->jobs[jobNum].output);
+    }
+
+    free(batch->programs);
+    free(batch->jobs);
+
+    *batch = {};
+}
+
+
+bool BatchRun(Batch* batch, BatchOptions* options, BatchStats* stats)
+{
+    size_t threadCount = (options->threadCount == 0) ? BatchGetCoreCount() : options->threadCount;
+    if (threadCount > batch->jobCount && batch->jobCount != 0)
+        threadCount = batch->jobCount;
+
+    BatchWorker* workers = (BatchWorker*) calloc(threadCount, sizeof(BatchWorker));
+    BatchQueue*  queues  = (BatchQueue*)  calloc(threadCount, sizeof(BatchQueue));
+    size_t*      jobNums = (size_t*)      calloc(batch->jobCount + 1, sizeof(size_t));
+    if (workers == NULL || queues == NULL || jobNums == NULL)
+    {
+        free(workers);
+        free(queues);
+        free(jobNums);
+        return false;
+    }
+
+    // Job jobNum is planned to thread jobNum % threadCount, so jobs of every queue are together.
+    size_t queueBegin = 0;
+    for (size_t queueNum = 0; queueNum < threadCount; queueNum++)
+    {
+        BatchQueue* queue = queues + queueNum;
+        queue->jobNums = jobNums + queueBegin;
+        for (size_t jobNum = queueNum; jobNum < batch->jobCount; jobNum += threadCount)
+            queue->jobNums[queue->bottom++] = jobNum;
+
+        queueBegin += queue->bottom;
+        pthread_mutex_init(&queue->mutex, NULL);
+
+        workers[queueNum] = {
+            .workerNum  = queueNum,
+            .batch      = batch,
+            .options    = options,
+            .queues     = queues,
+            .queueCount = threadCount,
+        };
+    }
+
+    const double startSeconds = GetSeconds();
+
+    // The first worker is run by this thread. If thread can't be started,
+    // its jobs are stolen by others.
+    size_t startedCount = 1;
+    for (size_t workerNum = 1; workerNum < threadCount; workerNum++)
+    {
+        if (pthread_create(&workers[workerNum].thread, NULL, BatchWorkerRun,
+                           workers + workerNum) != 0)
+        {
+            LOG_PRINT(ERROR, "Can't start thread %zu of batch.\n", workerNum);
+            break;
+        }
+
+        startedCount++;
+    }
+
+    BatchWorkerRun(workers);
+    for (size_t workerNum = 1; workerNum < startedCount; workerNum++)
+        pthread_join(workers[workerNum].thread, NULL);
+
+    if (stats != NULL)
+    {
+        *stats = {
+            .threadCount      = startedCount,
+            .executionSeconds = GetSeconds() - startSeconds,
+        };
+
+        for (size_t workerNum = 0; workerNum < threadCount; workerNum++)
+        {
+            stats->executedCount += workers[workerNum].executedCount;
+            stats->stolenCount   += workers[workerNum].stolenCount;
+        }
+    }
+
+    for (size_t queueNum = 0; queueNum < threadCount; queueNum++)
+        pthread_mutex_destroy(&queues[queueNum].mutex);
+
+    free(workers);
+    free(queues);
+    free(jobNums);
+    return true;
+}
+
+
+void BatchPrintResults(Batch* batch)
+{
+    for (size_t jobNum = 0; jobNum < batch->jobCount; jobNum++)
+    {
+        BatchJob* job = batch->jobs + jobNum;
+
+        ColoredPrintf(job->status == PROCESSOR_FINISHED ? GREEN : RED,
+                      "Job %zu (%s): %s, %zu instructions\n", jobNum,
+                      batch->programs[job->programNum].name, ProcessorStatusGetName(job->status),
+                      job->executedCount);
+
+        if (job->outputLength != 0)
+            ColoredPrintf(YELLOW, "%s", job->output);
+    }
+}
+
+
+size_t BatchGetCoreCount()
+{
+    long coreCount = sysconf(_SC_NPROCESSORS_ONLN);
+    if (coreCount < 1)
+        return 1;
+
+    return (size_t) coreCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool BatchLineParse(Batch* batch, char* line, size_t lineNum)
+{
+    char* wordEnd     = NULL;
+    char* programName = strtok_r(line, " \t\r", &wordEnd);
+    if (programName == NULL ||
+        strncmp(programName, BATCH_COMMENT_PREFIX, strlen(BATCH_COMMENT_PREFIX)) == 0)
+        return true;
+
+    size_t programNum = 0;
+    if (!BatchProgramFind(batch, programName, &programNum))
+    {
+        if (!BatchProgramAdd(batch, programName))
+        {
+            ColoredPrintf(RED, "Batch line %zu: can't load %s.\n", lineNum, programName);
+            return false;
+        }
+
+        programNum = batch->programCount - 1;
+    }
+
+    BatchJob* job = BatchJobAdd(batch, programNum);
+    if (job == NULL)
+        return false;
+
+    for (char* word = strtok_r(NULL, " \t\r", &wordEnd); word != NULL;
+               word = strtok_r(NULL, " \t\r", &wordEnd))
+    {
+        char* numberEnd = NULL;
+        instruction_t value = strtol(word, &numberEnd, 10);
+        if (*numberEnd != '\0')
+        {
+            ColoredPrintf(RED, "Batch line %zu: %s isn't a number.\n", lineNum, word);
+            return false;
+        }
+
+        if (!BatchJobInputAdd(job, value))
+            return false;
+    }
+
+    return true;
+}
+
+
+static bool BatchProgramFind(Batch* batch, const char* programName, size_t* programNumBuffer)
+{
+    for (size_t programNum = 0; programNum < batch->programCount; programNum++)
+    {
+        if (strcmp(batch->programs[programNum].name, programName) == 0)
+        {
+            *programNumBuffer = programNum;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static bool BatchProgramAdd(Batch* batch, const char* programName)
+{
+    if (batch->programCount == batch->programCapacity)
+    {
+        size_t newCapacity = batch->programCapacity * 2;
+        if (newCapacity < BATCH_MIN_CAPACITY)
+            newCapacity = BATCH_MIN_CAPACITY;
+
+        BatchProgram* newPrograms = (BatchProgram*) realloc(batch->programs,
+                                                            newCapacity * sizeof(BatchProgram));
+        if (newPrograms == NULL)
+            return false;
+
+        batch->programs        = newPrograms;
+        batch->programCapacity = newCapacity;
+    }
+
+    if (!Assemble(programName))
+        return false;
+
+    char* machineCodeFileName = NULL;
+    if (!FileNameChangeExtension(programName, &machineCodeFileName, ".asm",
+                                                       MACHINE_CODE_FILE_EXTENSION))
+        return false;
+
+    BatchProgram program = {.name = strdup(programName)};
+    bool isLoaded = (program.name != NULL &&
+                     MachineCodeInitFromFile(&program.machineCode, machineCodeFileName));
+    free(machineCodeFileName);
+
+    if (!isLoaded)
+    {
+        free(program.name);
+        MachineCodeDelete(&program.machineCode);
+        return false;
+    }
+
+    batch->programs[batch->programCount++] = program;
+    return true;
+}
+
+
+static BatchJob* BatchJobAdd(Batch* batch, size_t programNum)
+{
+    if (batch->jobCount == batch->jobCapacity)
+    {
+        size_t newCapacity = batch->jobCapacity * 2;
+        if (newCapacity < BATCH_MIN_CAPACITY)
+            newCapacity = BATCH_MIN_CAPACITY;
+
+        BatchJob* newJobs = (BatchJob*) realloc(batch->jobs, newCapacity * sizeof(BatchJob));
+        if (newJobs == NULL)
+            return NULL;
+
+        batch->jobs        = newJobs;
+        batch->jobCapacity = newCapacity;
+    }
+
+    BatchJob* job = batch->jobs + batch->jobCount++;
+    *job = {
+        .programNum = programNum,
+        .status     = PROCESSOR_BUDGET_EXHAUSTED,
+    };
+
+    return job;
+}
+
+
+static bool BatchJobInputAdd(BatchJob* job, instruction_t value)
+{
+    // Capacity is the least power of two which isn't less than inputCount.
+    if ((job->inputCount & (job->inputCount - 1)) == 0)
+    {
+        size_t newCapacity = (job->inputCount == 0) ? 1 : job->inputCount * 2;
+        instruction_t* newInputs = (instruction_t*) realloc(job->inputs,
+                                                            newCapacity * sizeof(instruction_t));
+        if (newInputs == NULL)
+            return false;
+
+        job->inputs = newInputs;
+    }
+
+    job->inputs[job->inputCount++] = value;
+    return true;
+}
+
+
+static void* BatchWorkerRun(void* workerPtr)
+{
+    BatchWorker* worker = (BatchWorker*) workerPtr;
+
+    size_t jobNum = 0;
+    while (BatchWorkerTakeJob(worker, &jobNum))
+    {
+        BatchJob* job = worker->batch->jobs + jobNum;
+        BatchJobExecute(worker->batch, worker->options, job);
+
+        worker->executedCount += job->executedCount;
+    }
+
+    return NULL;
+}
+
+
+/**
+ * Jobs are never added while batch is running, so if all queues are empty,
+ * there is nothing to wait for.
+ */
+static bool BatchWorkerTakeJob(BatchWorker* worker, size_t* jobNumBuffer)
+{
+    if (BatchQueuePop(worker->queues + worker->workerNum, jobNumBuffer))
+        return true;
+
+    for (size_t shift = 1; shift < worker->queueCount; shift++)
+    {
+        size_t victimNum = (worker->workerNum + shift) % worker->queueCount;
+        if (BatchQueueSteal(worker->queues + victimNum, jobNumBuffer))
+        {
+            worker->stolenCount++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static bool BatchQueuePop(BatchQueue* queue, size_t* jobNumBuffer)
+{
+    pthread_mutex_lock(&queue->mutex);
+
+    bool isTaken = (queue->bottom > queue->top);
+    if (isTaken)
+        *jobNumBuffer = queue->jobNums[--queue->bottom];
+
+    pthread_mutex_unlock(&queue->mutex);
+    return isTaken;
+}
+
+
+static bool BatchQueueSteal(BatchQueue* queue, size_t* jobNumBuffer)
+{
+    pthread_mutex_lock(&queue->mutex);
+
+    bool isTaken = (queue->bottom > queue->top);
+    if (isTaken)
+        *jobNumBuffer = queue->jobNums[queue->top++];
+
+    pthread_mutex_unlock(&queue->mutex);
+    return isTaken;
+}
+
+
+static void BatchJobExecute(Batch* batch, BatchOptions* options, BatchJob* job)
+{
+    Processor* processor = ProcessorCreateFromCode(&batch->programs[job->programNum].machineCode,
+                                                   options->processorOptions);
+    if (processor == NULL)
+    {
+        job->status = PROCESSOR_ERROR;
+        return;
+    }
+
+    for (size_t inputNum = 0; inputNum < job->inputCount; inputNum++)
+    {
+        if (!ProcessorInputAdd(processor, job->inputs[inputNum]))
+        {
+            job->status = PROCESSOR_ERROR;
+            ProcessorDestroy(processor);
+            return;
+        }
+    }
+
+    job->status        = ProcessorRun(processor, options->instructionLimit, 0);
+    job->executedCount = ProcessorGetExecutedCount(processor);
+
+    size_t      outputLength = 0;
+    const char* output       = ProcessorGetOutput(processor, &outputLength);
+
+    job->output = (char*) calloc(outputLength + 1, sizeof(char));
+    if (job->output != NULL)
+    {
+        memcpy(job->output, output, outputLength);
+        job->outputLength = outputLength;
+    }
+
+    ProcessorDestroy(processor);
+}
+
+
+static const char* ProcessorStatusGetName(processorStatus_t status)
+{
+    switch (status)
+    {
+    case PROCESSOR_BUDGET_EXHAUSTED:
+        return "instruction limit is reached";
+
+    case PROCESSOR_FINISHED:
+        return "finished";
+
+    case PROCESSOR_WAITING_FOR_INPUT:
+        return "input is missed";
+
+    case PROCESSOR_ERROR:
+        return "error";
+
+    default:
+        return "unknown status";
+    }
+}
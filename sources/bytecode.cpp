@@ -0,0 +1,271 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "bytecode.h"
+#include "virtualMachine.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static const size_t  CMD_NAME_BIT_COUNT = 5;
+static const uint8_t CMD_NAME_MASK      = (1 << CMD_NAME_BIT_COUNT) - 1;
+static const uint8_t PUSH_POP_MODE_MASK = 0x7;
+static const uint8_t REGISTER_MASK      = 0xF;
+
+static const size_t  VARINT_BIT_COUNT   = 7;
+static const uint8_t VARINT_MASK        = (1 << VARINT_BIT_COUNT) - 1;
+static const uint8_t VARINT_CONTINUE    = 1 << VARINT_BIT_COUNT;
+
+/**
+ * Bytes of the longest varint of 64-bit number.
+ */
+static const size_t VARINT_MAX_LENGTH = 10;
+
+
+/**
+ * What follows command byte.
+ */
+enum OPERAND_KINDS
+{
+    OPERANDS_WRONG,         /**< Unknown command.                                   */
+    OPERANDS_NONE,
+    OPERANDS_PUSH_POP,      /**< Register byte and varint which are set by mode.    */
+    OPERANDS_NUMBER         /**< One varint: jump target or SYSCALL function.       */
+};
+typedef enum OPERAND_KINDS operandKind_t;
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static operandKind_t CmdGetOperandKind(instruction_t cmdName);
+
+
+static bool CmdEncode(const instruction_t* code, size_t instructionCount, size_t* instructionNum,
+                      uint8_t* bytecode, size_t* size);
+
+
+static size_t VarintWrite(uint8_t* bytes, instruction_t value);
+
+
+static bool VarintRead(const uint8_t* bytes, size_t size, size_t* byteNum,
+                       instruction_t* valueBuffer);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+uint8_t* BytecodeEncode(const instruction_t* code, size_t instructionCount, size_t* sizeBuffer)
+{
+    // Every word takes at most one varint.
+    uint8_t* bytecode = (uint8_t*) calloc(instructionCount * VARINT_MAX_LENGTH + 1,
+                                          sizeof(uint8_t));
+    if (bytecode == NULL)
+        return NULL;
+
+    size_t size = 0;
+    for (size_t instructionNum = 0; instructionNum < instructionCount; )
+    {
+        if (!CmdEncode(code, instructionCount, &instructionNum, bytecode, &size))
+        {
+            LOG_PRINT(ERROR, "Instruction %zu can't be encoded to bytecode.\n", instructionNum);
+            free(bytecode);
+            return NULL;
+        }
+    }
+
+    *sizeBuffer = size;
+    return bytecode;
+}
+
+
+bool BytecodeDecode(const uint8_t* bytecode, size_t size, instruction_t* code,
+                    size_t instructionCount)
+{
+    size_t instructionNum = 0;
+
+#define WRITE_WORD_(word)                                   \
+{                                                           \
+    if (instructionNum == instructionCount)                 \
+        return false;                                       \
+    code[instructionNum++] = (word);                        \
+}
+
+    for (size_t byteNum = 0; byteNum < size; )
+    {
+        const uint8_t       cmdByte = bytecode[byteNum++];
+        const instruction_t cmdName = cmdByte & CMD_NAME_MASK;
+        const instruction_t mode    = cmdByte >> CMD_NAME_BIT_COUNT;
+        const operandKind_t kind    = CmdGetOperandKind(cmdName);
+        if (kind == OPERANDS_WRONG || (kind != OPERANDS_PUSH_POP && mode != 0))
+            return false;
+
+        WRITE_WORD_(cmdName);
+
+        instruction_t operand = 0;
+        if (kind == OPERANDS_NUMBER)
+        {
+            if (!VarintRead(bytecode, size, &byteNum, &operand))
+                return false;
+
+            WRITE_WORD_(operand);
+        }
+        else if (kind == OPERANDS_PUSH_POP)
+        {
+            PushPopMode pushPopMode = {};
+            memcpy(&pushPopMode, &mode, sizeof(PushPopMode));
+            WRITE_WORD_(mode);
+
+            if (pushPopMode.isRegister)
+            {
+                if (byteNum == size || (bytecode[byteNum] & ~REGISTER_MASK) != 0)
+                    return false;
+
+                WRITE_WORD_(bytecode[byteNum++]);
+            }
+
+            if (pushPopMode.isConst)
+            {
+                if (!VarintRead(bytecode, size, &byteNum, &operand))
+                    return false;
+
+                WRITE_WORD_(operand);
+            }
+        }
+    }
+
+#undef WRITE_WORD_
+
+    return instructionNum == instructionCount;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static operandKind_t CmdGetOperandKind(instruction_t cmdName)
+{
+    switch (cmdName)
+    {
+    case PUSH:
+    case POP:
+        return OPERANDS_PUSH_POP;
+
+    case JMP: case JA: case JAE: case JB: case JBE: case JE: case JNE:
+    case CALL:
+    case SYSCALL:
+        return OPERANDS_NUMBER;
+
+    case ADD: case SUB: case MUL: case DIV:
+    case SQRT: case SIN: case COS:
+    case IN: case OUT:
+    case DRAW:
+    case RET:
+    case FLUSH:
+        return OPERANDS_NONE;
+
+    case CMD_NAME_WRONG:
+    default:
+        return OPERANDS_WRONG;
+    }
+}
+
+
+/**
+ * Encode command which starts at instructionNum and move instructionNum after it.
+ *
+ * @return false if command is unknown, its operand is cut or doesn't fit its field.
+ */
+static bool CmdEncode(const instruction_t* code, size_t instructionCount, size_t* instructionNum,
+                      uint8_t* bytecode, size_t* size)
+{
+    const instruction_t cmdName = code[*instructionNum];
+    const operandKind_t kind    = CmdGetOperandKind(cmdName);
+    if (kind == OPERANDS_WRONG || cmdName > CMD_NAME_MASK)
+        return false;
+
+    if (kind == OPERANDS_NONE)
+    {
+        bytecode[(*size)++] = (uint8_t) cmdName;
+        (*instructionNum)++;
+        return true;
+    }
+
+    if (kind == OPERANDS_NUMBER)
+    {
+        if (*instructionNum + 1 >= instructionCount)
+            return false;
+
+        bytecode[(*size)++] = (uint8_t) cmdName;
+        *size += VarintWrite(bytecode + *size, code[*instructionNum + 1]);
+        *instructionNum += 2;
+        return true;
+    }
+
+    if (*instructionNum + 1 >= instructionCount ||
+        (code[*instructionNum + 1] & ~(instruction_t) PUSH_POP_MODE_MASK) != 0)
+        return false;
+
+    const instruction_t mode        = code[*instructionNum + 1];
+    PushPopMode         pushPopMode = {};
+    memcpy(&pushPopMode, &mode, sizeof(PushPopMode));
+
+    size_t operandNum = *instructionNum + 2;
+    const size_t commandEnd = operandNum + (size_t) (pushPopMode.isRegister != 0) +
+                                           (size_t) (pushPopMode.isConst    != 0);
+    if (commandEnd > instructionCount ||
+        (pushPopMode.isRegister && (code[operandNum] & ~(instruction_t) REGISTER_MASK) != 0))
+        return false;
+
+    bytecode[(*size)++] = (uint8_t) (cmdName | (mode << CMD_NAME_BIT_COUNT));
+    if (pushPopMode.isRegister)
+        bytecode[(*size)++] = (uint8_t) code[operandNum++];
+
+    if (pushPopMode.isConst)
+        *size += VarintWrite(bytecode + *size, code[operandNum]);
+
+    *instructionNum = commandEnd;
+    return true;
+}
+
+
+/**
+ * Zig-zag keeps small negative numbers short: 0, -1, 1, -2, ... become 0, 1, 2, 3, ...
+ *
+ * @return length of varint.
+ */
+static size_t VarintWrite(uint8_t* bytes, instruction_t value)
+{
+    uint64_t zigZag = ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+
+    size_t length = 0;
+    while (zigZag > VARINT_MASK)
+    {
+        bytes[length++] = (uint8_t) ((zigZag & VARINT_MASK) | VARINT_CONTINUE);
+        zigZag >>= VARINT_BIT_COUNT;
+    }
+    bytes[length++] = (uint8_t) zigZag;
+
+    return length;
+}
+
+
+static bool VarintRead(const uint8_t* bytes, size_t size, size_t* byteNum,
+                       instruction_t* valueBuffer)
+{
+    uint64_t zigZag = 0;
+    for (size_t length = 0; length < VARINT_MAX_LENGTH && *byteNum < size; length++)
+    {
+        const uint8_t byte = bytes[(*byteNum)++];
+        zigZag |= (uint64_t) (byte & VARINT_MASK) << (length * VARINT_BIT_COUNT);
+        if ((byte & VARINT_CONTINUE) == 0)
+        {
+            *valueBuffer = (instruction_t) ((zigZag >> 1) ^ (0 - (zigZag & 1)));
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,645 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "decodedCode.h"
+#include "virtualMachine.h"
+#include "register64.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static const size_t DECODED_NUM_POISON = (size_t) -1;
+
+
+#define DEF_DECODED_CMD_(CMD_NAME, ...) \
+    , GET_NAME(CMD_NAME)
+
+static const char* const DECODED_CMD_NAMES[] = 
+{
+    "WRONG"
+    #include "decodedCommands.h"
+};
+#undef DEF_DECODED_CMD_
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool InstructionGetLength(MachineCode* machineCode, size_t instructionNum,
+                                 size_t* lengthBuffer);
+
+
+static bool InstructionDecode(MachineCode* machineCode, size_t instructionNum,
+                              size_t* decodedNums, DecodedInstruction* decodedInstruction);
+
+
+static bool PushPopDecode(instruction_t* operands, cmdName_t cmdName,
+                          DecodedInstruction* decodedInstruction);
+
+
+static bool JumpTargetDecode(MachineCode* machineCode, instruction_t jumpTarget,
+                             size_t* decodedNums, uint32_t* decodedTargetBuffer);
+
+
+static bool DecodedCmdIsJump(uint8_t cmdName);
+
+
+static void DecodedNumsUpdate(DecodedCode* decodedCode);
+
+
+static size_t InstructionsFuse(DecodedInstruction* instructions, size_t instructionCount,
+                               bool* isJumpTarget, PairProfile* pairProfile, 
+                               DecodedInstruction* fusedBuffer);
+
+
+static bool InstructionsAreHot(DecodedInstruction* instructions, size_t instructionCount,
+                               PairProfile* pairProfile);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool DecodedCodeInit(DecodedCode* decodedCode, MachineCode* machineCode)
+{
+    const size_t instructionCount = machineCode->instructionCount;
+
+    // decodedNums[n] is number of decoded instruction which starts at machine code word n.
+    size_t* decodedNums = (size_t*) calloc(instructionCount + 1, sizeof(size_t));
+    if (decodedNums == NULL)
+        return false;
+
+    size_t decodedCount = 0;
+    for (size_t instructionNum = 0; instructionNum < instructionCount; instructionNum++)
+        decodedNums[instructionNum] = DECODED_NUM_POISON;
+
+    for (size_t instructionNum = 0; instructionNum < instructionCount;)
+    {
+        size_t instructionLength = 0;
+        if (!InstructionGetLength(machineCode, instructionNum, &instructionLength))
+        {
+            free(decodedNums);
+            return false;
+        }
+
+        decodedNums[instructionNum] = decodedCount++;
+        instructionNum += instructionLength;
+    }
+    decodedNums[instructionCount] = decodedCount;
+
+    if (decodedCount > UINT32_MAX)
+    {
+        LOG_PRINT(ERROR, "Too many instructions to decode: %zu.\n", decodedCount);
+        free(decodedNums);
+        return false;
+    }
+
+    // +1 for DECODED_HALT after the last instruction
+    decodedCode->instructions    = (DecodedInstruction*) calloc(decodedCount + 1, 
+                                                                sizeof(DecodedInstruction));
+    decodedCode->machineCodeNums = (size_t*) calloc(decodedCount + 1, sizeof(size_t));
+    if (decodedCode->instructions == NULL || decodedCode->machineCodeNums == NULL)
+    {
+        free(decodedNums);
+        DecodedCodeDelete(decodedCode);
+        return false;
+    }
+    decodedCode->instructionCount = decodedCount;
+    decodedCode->machineCodeSize  = instructionCount;
+
+    for (size_t instructionNum = 0; instructionNum < instructionCount; instructionNum++)
+    {
+        if (decodedNums[instructionNum] == DECODED_NUM_POISON)
+            continue;
+
+        DecodedInstruction* decodedInstruction = decodedCode->instructions + 
+                                                 decodedNums[instructionNum];
+        if (!InstructionDecode(machineCode, instructionNum, decodedNums, decodedInstruction))
+        {
+            free(decodedNums);
+            DecodedCodeDelete(decodedCode);
+            return false;
+        }
+
+        decodedCode->machineCodeNums[decodedNums[instructionNum]] = instructionNum;
+    }
+    decodedCode->machineCodeNums[decodedCount] = instructionCount;
+    decodedCode->instructions[decodedCount].cmdName = DECODED_HALT;
+
+    // Poisoned words are filled with numbers of instructions which contain them.
+    decodedCode->decodedNums = decodedNums;
+    DecodedNumsUpdate(decodedCode);
+
+    return true;
+}
+
+
+void DecodedCodeDelete(DecodedCode* decodedCode)
+{
+    free(decodedCode->instructions);
+    free(decodedCode->machineCodeNums);
+    free(decodedCode->decodedNums);
+
+    decodedCode->instructions     = NULL;
+    decodedCode->instructionCount = 0;
+    decodedCode->machineCodeNums  = NULL;
+    decodedCode->decodedNums      = NULL;
+    decodedCode->machineCodeSize  = 0;
+}
+
+
+bool DecodedCodeCopy(DecodedCode* source, DecodedCode* copy)
+{
+    const size_t instructionCount = source->instructionCount;
+    const size_t machineCodeSize  = source->machineCodeSize;
+
+    *copy = {
+        .instructions     = (DecodedInstruction*) calloc(instructionCount + 1, 
+                                                         sizeof(DecodedInstruction)),
+        .instructionCount = instructionCount,
+        .machineCodeNums  = (size_t*) calloc(instructionCount + 1, sizeof(size_t)),
+        .decodedNums      = (size_t*) calloc(machineCodeSize  + 1, sizeof(size_t)),
+        .machineCodeSize  = machineCodeSize,
+    };
+
+    if (copy->instructions == NULL || copy->machineCodeNums == NULL || copy->decodedNums == NULL)
+    {
+        DecodedCodeDelete(copy);
+        return false;
+    }
+
+    memcpy(copy->instructions,    source->instructions, 
+           (instructionCount + 1) * sizeof(DecodedInstruction));
+    memcpy(copy->machineCodeNums, source->machineCodeNums, 
+           (instructionCount + 1) * sizeof(size_t));
+    memcpy(copy->decodedNums,     source->decodedNums,
+           (machineCodeSize  + 1) * sizeof(size_t));
+
+    return true;
+}
+
+
+bool DecodedCodeFuse(DecodedCode* decodedCode, PairProfile* pairProfile)
+{
+    const size_t instructionCount   = decodedCode->instructionCount;
+    DecodedInstruction* instructions = decodedCode->instructions;
+    size_t* machineCodeNums          = decodedCode->machineCodeNums;
+
+    bool*   isJumpTarget = (bool*)   calloc(instructionCount + 1, sizeof(bool));
+    size_t* fusedNums    = (size_t*) calloc(instructionCount + 1, sizeof(size_t));
+    if (isJumpTarget == NULL || fusedNums == NULL)
+    {
+        free(isJumpTarget);
+        free(fusedNums);
+        return false;
+    }
+
+    for (size_t instructionNum = 0; instructionNum < instructionCount; instructionNum++)
+    {
+        DecodedInstruction* instruction = instructions + instructionNum;
+        if (DecodedCmdIsJump(instruction->cmdName))
+            isJumpTarget[instruction->jumpTarget] = true;
+
+        // RET jumps to instruction after CALL
+        if (instruction->cmdName == DECODED_CALL)
+            isJumpTarget[instructionNum + 1] = true;
+    }
+
+    // Fused code is written over old one, it is never longer.
+    size_t fusedCount = 0;
+    for (size_t instructionNum = 0; instructionNum < instructionCount;)
+    {
+        DecodedInstruction fusedInstruction = {};
+        size_t fusedLength = InstructionsFuse(instructions + instructionNum, 
+                                              instructionCount - instructionNum, 
+                                              isJumpTarget + instructionNum, pairProfile,
+                                              &fusedInstruction);
+        if (fusedLength == 0)
+        {
+            fusedInstruction = instructions[instructionNum];
+            fusedLength      = 1;
+        }
+
+        fusedNums[instructionNum] = fusedCount;
+        for (size_t innerNum = 1; innerNum < fusedLength; innerNum++)
+            fusedNums[instructionNum + innerNum] = DECODED_NUM_POISON;
+
+        machineCodeNums[fusedCount] = machineCodeNums[instructionNum];
+        instructions[fusedCount++]  = fusedInstruction;
+        instructionNum += fusedLength;
+    }
+    fusedNums[instructionCount]  = fusedCount;
+    machineCodeNums[fusedCount] = machineCodeNums[instructionCount];
+    instructions[fusedCount]    = instructions[instructionCount];
+
+    for (size_t instructionNum = 0; instructionNum < fusedCount; instructionNum++)
+    {
+        DecodedInstruction* instruction = instructions + instructionNum;
+        if (DecodedCmdIsJump(instruction->cmdName))
+            instruction->jumpTarget = (uint32_t) fusedNums[instruction->jumpTarget];
+    }
+
+    decodedCode->instructionCount = fusedCount;
+    DecodedNumsUpdate(decodedCode);
+
+    free(isJumpTarget);
+    free(fusedNums);
+    return true;
+}
+
+
+const char* DecodedCmdGetName(decodedCmdName_t cmdName)
+{
+    if ((size_t) cmdName >= DECODED_CMD_COUNT)
+        return DECODED_CMD_NAMES[DECODED_CMD_NAME_WRONG];
+
+    return DECODED_CMD_NAMES[cmdName];
+}
+
+
+bool DecodedCmdFromName(const char* name, decodedCmdName_t* cmdNameBuffer)
+{
+    for (size_t cmdNum = DECODED_CMD_NAME_WRONG + 1; cmdNum < DECODED_CMD_COUNT; cmdNum++)
+        if (strcmp(name, DECODED_CMD_NAMES[cmdNum]) == 0)
+        {
+            *cmdNameBuffer = (decodedCmdName_t) cmdNum;
+            return true;
+        }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool InstructionGetLength(MachineCode* machineCode, size_t instructionNum,
+                                 size_t* lengthBuffer)
+{
+    instruction_t cmdName = machineCode->code[instructionNum];
+    switch (cmdName)
+    {
+    case PUSH:
+    case POP:
+    {
+        if (instructionNum + 1 >= machineCode->instructionCount)
+        {
+            LOG_PRINT(ERROR, "Instruction %zu: PushPopMode is missed.\n", instructionNum);
+            return false;
+        }
+
+        PushPopMode pushPopMode = {};
+        memcpy(&pushPopMode, machineCode->code + instructionNum + 1, sizeof(PushPopMode));
+        *lengthBuffer = 2 + (size_t) (pushPopMode.isRegister != 0) + 
+                            (size_t) (pushPopMode.isConst    != 0);
+        break;
+    }
+
+    case JMP: case JA: case JAE: case JB: case JBE: case JE: case JNE:
+    case CALL:
+    case SYSCALL:
+        *lengthBuffer = 2;
+        break;
+
+    case ADD: case SUB: case MUL: case DIV:
+    case SQRT: case SIN: case COS:
+    case IN: case OUT:
+    case DRAW:
+    case RET:
+    case FLUSH:
+        *lengthBuffer = 1;
+        break;
+
+    case CMD_NAME_WRONG:
+    default:
+        LOG_PRINT(ERROR, "Instruction %zu: wrong cmdName = %ld.\n", instructionNum, cmdName);
+        return false;
+    }
+
+    if (instructionNum + *lengthBuffer > machineCode->instructionCount)
+    {
+        LOG_PRINT(ERROR, "Instruction %zu: operands are missed.\n", instructionNum);
+        return false;
+    }
+
+    return true;
+}
+
+
+#define DECODE_AS_IS_(CMD_NAME)                             \
+    case CMD_NAME:                                          \
+        decodedInstruction->cmdName = DECODED_##CMD_NAME;   \
+        return true;
+
+#define DECODE_JUMP_(CMD_NAME)                                                      \
+    case CMD_NAME:                                                                  \
+        decodedInstruction->cmdName = DECODED_##CMD_NAME;                           \
+        return JumpTargetDecode(machineCode, operands[0], decodedNums,              \
+                                &decodedInstruction->jumpTarget);
+
+static bool InstructionDecode(MachineCode* machineCode, size_t instructionNum,
+                              size_t* decodedNums, DecodedInstruction* decodedInstruction)
+{
+    cmdName_t      cmdName  = (cmdName_t) machineCode->code[instructionNum];
+    instruction_t* operands = machineCode->code + instructionNum + 1;
+
+    switch (cmdName)
+    {
+    case PUSH:
+    case POP:
+        return PushPopDecode(operands, cmdName, decodedInstruction);
+
+    DECODE_JUMP_(JMP)
+    DECODE_JUMP_(JA)
+    DECODE_JUMP_(JAE)
+    DECODE_JUMP_(JB)
+    DECODE_JUMP_(JBE)
+    DECODE_JUMP_(JE)
+    DECODE_JUMP_(JNE)
+    DECODE_JUMP_(CALL)
+
+    DECODE_AS_IS_(ADD)
+    DECODE_AS_IS_(SUB)
+    DECODE_AS_IS_(MUL)
+    DECODE_AS_IS_(DIV)
+    DECODE_AS_IS_(SQRT)
+    DECODE_AS_IS_(SIN)
+    DECODE_AS_IS_(COS)
+    DECODE_AS_IS_(IN)
+    DECODE_AS_IS_(OUT)
+    DECODE_AS_IS_(DRAW)
+    DECODE_AS_IS_(RET)
+    DECODE_AS_IS_(FLUSH)
+
+    case SYSCALL:
+        decodedInstruction->cmdName   = DECODED_SYSCALL;
+        decodedInstruction->immediate = operands[0];
+        return true;
+
+    case CMD_NAME_WRONG:
+    default:
+        LOG_PRINT(ERROR, "Instruction %zu: wrong cmdName = %d.\n", instructionNum, cmdName);
+        return false;
+    }
+}
+#undef DECODE_AS_IS_
+#undef DECODE_JUMP_
+
+
+static bool PushPopDecode(instruction_t* operands, cmdName_t cmdName,
+                          DecodedInstruction* decodedInstruction)
+{
+    PushPopMode pushPopMode = {};
+    memcpy(&pushPopMode, operands, sizeof(PushPopMode));
+    operands++;
+
+    if (pushPopMode.isRegister)
+    {
+        instruction_t registerName = *(operands++);
+        if (registerName < RAX || (size_t) (registerName - RAX) >= REGISTER_COUNT)
+        {
+            LOG_PRINT(ERROR, "Wrong registerName = %ld.\n", registerName);
+            return false;
+        }
+
+        decodedInstruction->registerNum = (uint8_t) (registerName - RAX);
+    }
+
+    if (pushPopMode.isConst)
+        decodedInstruction->immediate = *operands;
+
+    // Without register and constant PUSH pushes 0 and POP [] pops to cell 0,
+    // so they are the same as constant 0.
+    #define CHOOSE_BY_MODE_(PREFIX)                                                \
+        (pushPopMode.isRegister && pushPopMode.isConst ? PREFIX##REGISTER_CONST :  \
+         pushPopMode.isRegister                        ? PREFIX##REGISTER       :  \
+                                                         PREFIX##CONST)
+
+    if (cmdName == PUSH)
+    {
+        if (pushPopMode.isRAM)
+            decodedInstruction->cmdName = CHOOSE_BY_MODE_(DECODED_PUSH_RAM_);
+        else
+            decodedInstruction->cmdName = CHOOSE_BY_MODE_(DECODED_PUSH_);
+
+        return true;
+    }
+
+    if (pushPopMode.isRAM)
+    {
+        decodedInstruction->cmdName = CHOOSE_BY_MODE_(DECODED_POP_RAM_);
+        return true;
+    }
+    #undef CHOOSE_BY_MODE_
+
+    if (!pushPopMode.isRegister || pushPopMode.isConst)
+    {
+        LOG_PRINT(ERROR, "Wrong pop format.\n");
+        return false;
+    }
+
+    decodedInstruction->cmdName = DECODED_POP_REGISTER;
+    return true;
+}
+
+
+static bool JumpTargetDecode(MachineCode* machineCode, instruction_t jumpTarget,
+                             size_t* decodedNums, uint32_t* decodedTargetBuffer)
+{
+    if (jumpTarget < (instruction_t) FIRST_INSTRUCTION_NUM || 
+        (size_t) jumpTarget > machineCode->instructionCount)
+    {
+        LOG_PRINT(ERROR, "Jump target = %ld is out of code.\n", jumpTarget);
+        return false;
+    }
+
+    if (decodedNums[jumpTarget] == DECODED_NUM_POISON)
+    {
+        LOG_PRINT(ERROR, "Jump target = %ld isn't a beginning of instruction.\n", jumpTarget);
+        return false;
+    }
+
+    *decodedTargetBuffer = (uint32_t) decodedNums[jumpTarget];
+    return true;
+}
+
+
+#define FUSED_JUMP_CASES_(CASE)                                     \
+    CASE(JA) CASE(JAE) CASE(JB) CASE(JBE) CASE(JE) CASE(JNE)
+
+static bool DecodedCmdIsJump(uint8_t cmdName)
+{
+    switch (cmdName)
+    {
+    case DECODED_JMP: case DECODED_JA: case DECODED_JAE: case DECODED_JB: case DECODED_JBE: 
+    case DECODED_JE:  case DECODED_JNE:
+    case DECODED_CALL:
+        return true;
+
+    #define IS_FUSED_JUMP_(JUMP_NAME)               \
+        case DECODED_FUSED_##JUMP_NAME##_CONST:     \
+        case DECODED_FUSED_##JUMP_NAME##_REGISTER:  \
+            return true;
+
+    FUSED_JUMP_CASES_(IS_FUSED_JUMP_)
+    #undef IS_FUSED_JUMP_
+
+    default:
+        return false;
+    }
+}
+
+
+static void DecodedNumsUpdate(DecodedCode* decodedCode)
+{
+    for (size_t decodedNum = 0; decodedNum < decodedCode->instructionCount; decodedNum++)
+        for (size_t wordNum  = decodedCode->machineCodeNums[decodedNum];
+                    wordNum  < decodedCode->machineCodeNums[decodedNum + 1]; wordNum++)
+            decodedCode->decodedNums[wordNum] = decodedNum;
+
+    decodedCode->decodedNums[decodedCode->machineCodeSize] = decodedCode->instructionCount;
+}
+
+
+static size_t InstructionsFuse(DecodedInstruction* instructions, size_t instructionCount,
+                               bool* isJumpTarget, PairProfile* pairProfile, 
+                               DecodedInstruction* fusedBuffer)
+{
+    #define CMD_(instructionNum) \
+        (instructions[instructionNum].cmdName)
+
+    #define FUSE_IF_(LENGTH, CONDITION, FILL_FUSED)                                 \
+    {                                                                               \
+        bool canBeFused = (LENGTH <= instructionCount);                             \
+        for (size_t innerNum = 1; canBeFused && innerNum < LENGTH; innerNum++)      \
+            canBeFused = !isJumpTarget[innerNum];                                   \
+                                                                                    \
+        if (canBeFused && (CONDITION) &&                                            \
+            InstructionsAreHot(instructions, LENGTH, pairProfile))                  \
+        {                                                                           \
+            *fusedBuffer = {};                                                      \
+            FILL_FUSED;                                                             \
+            return LENGTH;                                                          \
+        }                                                                           \
+    }
+
+    #define SET_FUSED_(CMD_NAME, REGISTER_NUM, SECOND_REGISTER_NUM, RESULT_REGISTER_NUM,    \
+                       IMMEDIATE, JUMP_TARGET)                                              \
+    {                                                                                       \
+        fusedBuffer->cmdName           = CMD_NAME;                                          \
+        fusedBuffer->registerNum       = REGISTER_NUM;                                      \
+        fusedBuffer->secondRegisterNum = SECOND_REGISTER_NUM;                               \
+        fusedBuffer->resultRegisterNum = RESULT_REGISTER_NUM;                               \
+        fusedBuffer->immediate         = IMMEDIATE;                                         \
+        fusedBuffer->jumpTarget        = JUMP_TARGET;                                       \
+    }
+
+    // Second PUSH of arithmetic and jump superinstructions can be PUSH c or PUSH reg2.
+    #define CHOOSE_BY_SECOND_PUSH_(FUSED_PREFIX)                                \
+        (CMD_(1) == DECODED_PUSH_CONST ? FUSED_PREFIX##_CONST : FUSED_PREFIX##_REGISTER)
+
+    const DecodedInstruction* first  = instructions;
+    const DecodedInstruction* second = instructions + 1;
+
+    bool isSecondPushSimple = instructionCount > 1 && 
+                              (CMD_(1) == DECODED_PUSH_CONST || CMD_(1) == DECODED_PUSH_REGISTER);
+
+    // PUSH reg1 ; PUSH c or reg2 ; ADD/SUB/MUL ; POP result
+    FUSE_IF_(4, CMD_(0) == DECODED_PUSH_REGISTER && isSecondPushSimple &&
+                (CMD_(2) == DECODED_ADD || CMD_(2) == DECODED_SUB || CMD_(2) == DECODED_MUL) &&
+                CMD_(3) == DECODED_POP_REGISTER,
+    {
+        uint8_t fusedCmdName = DECODED_CMD_NAME_WRONG;
+        switch (CMD_(2))
+        {
+        case DECODED_ADD: fusedCmdName = CHOOSE_BY_SECOND_PUSH_(DECODED_FUSED_ADD); break;
+        case DECODED_SUB: fusedCmdName = CHOOSE_BY_SECOND_PUSH_(DECODED_FUSED_SUB); break;
+        case DECODED_MUL: fusedCmdName = CHOOSE_BY_SECOND_PUSH_(DECODED_FUSED_MUL); break;
+        default:                                                                    break;
+        }
+
+        SET_FUSED_(fusedCmdName, first->registerNum, second->registerNum, 
+                   instructions[3].registerNum, second->immediate, 0);
+    })
+
+    // PUSH reg1 ; PUSH c or reg2 ; Jcc label
+    #define IS_CONDITIONAL_JUMP_(JUMP_NAME) \
+        || CMD_(2) == DECODED_##JUMP_NAME
+
+    #define CHOOSE_FUSED_JUMP_(JUMP_NAME)                                       \
+        case DECODED_##JUMP_NAME:                                               \
+            fusedCmdName = CHOOSE_BY_SECOND_PUSH_(DECODED_FUSED_##JUMP_NAME);   \
+            break;
+
+    FUSE_IF_(3, CMD_(0) == DECODED_PUSH_REGISTER && isSecondPushSimple && 
+                (false FUSED_JUMP_CASES_(IS_CONDITIONAL_JUMP_)),
+    {
+        uint8_t fusedCmdName = DECODED_CMD_NAME_WRONG;
+        switch (CMD_(2))
+        {
+        FUSED_JUMP_CASES_(CHOOSE_FUSED_JUMP_)
+        default:
+            break;
+        }
+
+        SET_FUSED_(fusedCmdName, first->registerNum, second->registerNum, 0,
+                   second->immediate, instructions[2].jumpTarget);
+    })
+    #undef IS_CONDITIONAL_JUMP_
+    #undef CHOOSE_FUSED_JUMP_
+
+    // PUSH reg1 (+ c) ; POP reg2
+    FUSE_IF_(2, (CMD_(0) == DECODED_PUSH_REGISTER || CMD_(0) == DECODED_PUSH_REGISTER_CONST) &&
+                CMD_(1) == DECODED_POP_REGISTER,
+             SET_FUSED_(DECODED_FUSED_MOVE_REGISTER, first->registerNum, 0, second->registerNum,
+                        first->immediate, 0))
+
+    // PUSH c ; POP reg2
+    FUSE_IF_(2, CMD_(0) == DECODED_PUSH_CONST && CMD_(1) == DECODED_POP_REGISTER,
+             SET_FUSED_(DECODED_FUSED_MOVE_CONST, 0, 0, second->registerNum, first->immediate, 0))
+
+    // PUSH [reg1 (+ c)] ; POP reg2
+    FUSE_IF_(2, (CMD_(0) == DECODED_PUSH_RAM_REGISTER || 
+                 CMD_(0) == DECODED_PUSH_RAM_REGISTER_CONST) && 
+                CMD_(1) == DECODED_POP_REGISTER,
+             SET_FUSED_(DECODED_FUSED_LOAD, first->registerNum, 0, second->registerNum,
+                        first->immediate, 0))
+
+    // PUSH reg1 ; POP [reg2 (+ c)]
+    FUSE_IF_(2, CMD_(0) == DECODED_PUSH_REGISTER && 
+                (CMD_(1) == DECODED_POP_RAM_REGISTER || 
+                 CMD_(1) == DECODED_POP_RAM_REGISTER_CONST),
+             SET_FUSED_(DECODED_FUSED_STORE, first->registerNum, second->registerNum, 0,
+                        second->immediate, 0))
+
+    // POP reg1 ; POP reg2
+    FUSE_IF_(2, CMD_(0) == DECODED_POP_REGISTER && CMD_(1) == DECODED_POP_REGISTER,
+             SET_FUSED_(DECODED_FUSED_POP_POP, first->registerNum, second->registerNum, 0, 0, 0))
+
+    #undef CMD_
+    #undef FUSE_IF_
+    #undef SET_FUSED_
+    #undef CHOOSE_BY_SECOND_PUSH_
+
+    return 0;
+}
+#undef FUSED_JUMP_CASES_
+
+
+static bool InstructionsAreHot(DecodedInstruction* instructions, size_t instructionCount,
+                               PairProfile* pairProfile)
+{
+    if (pairProfile == NULL)
+        return true;
+
+    for (size_t instructionNum = 1; instructionNum < instructionCount; instructionNum++)
+        if (!PairProfileIsHot(pairProfile, instructions[instructionNum - 1].cmdName,
+                                           instructions[instructionNum].cmdName))
+        {
+            return false;
+        }
+
+    return true;
+}
@@ -24,7 +24,7 @@ bool FileNameCheckExtension(const char* fileName, const char* extension)
 }
 
 
-bool FileNameChangeExtension(char* prevFileName, char** newFileNameBuffer,
+bool FileNameChangeExtension(const char* prevFileName, char** newFileNameBuffer,
                              const char* prevExtension, const char* newExtension)
 {
     if (*newFileNameBuffer != NULL)
@@ -0,0 +1,303 @@
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "frameCapture.h"
+#include "fnvHash.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static const size_t FRAME_CAPTURE_MIN_CAPACITY = 256;
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool FrameCaptureResize(FrameCapture* capture, size_t frameCapacity);
+
+
+static inline FrameFileHeader* FrameCaptureGetHeader(FrameCapture* capture);
+
+
+static void PixelsPack(const Pixel* pixels, PackedPixel* packedPixels, size_t pixelCount);
+
+
+static uint64_t PixelsHash(const PackedPixel* packedPixels, size_t pixelCount);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool FrameCaptureOpen(FrameCapture* capture, const char* fileName, size_t width, size_t height,
+                      size_t frameStep, bool isHashOnly)
+{
+    const size_t pixelCount = width * height;
+
+    *capture = {
+        .fd          = open(fileName, O_RDWR | O_CREAT | O_TRUNC, 0644),
+        .mapped      = NULL,
+        .mappedSize  = 0,
+        .frameSize   = isHashOnly ? sizeof(uint64_t) : pixelCount * sizeof(PackedPixel),
+        .packedFrame = NULL,
+    };
+    if (capture->fd == -1)
+    {
+        LOG_PRINT(ERROR, "Can't open frame file %s.\n", fileName);
+        return false;
+    }
+
+    if (isHashOnly)
+        capture->packedFrame = (PackedPixel*) calloc(pixelCount, sizeof(PackedPixel));
+
+    if ((isHashOnly && capture->packedFrame == NULL) ||
+        !FrameCaptureResize(capture, FRAME_CAPTURE_MIN_CAPACITY))
+    {
+        close(capture->fd);
+        free(capture->packedFrame);
+        *capture = {};
+        return false;
+    }
+
+    FrameFileHeader* header = FrameCaptureGetHeader(capture);
+    *header = {
+        .signature  = {},
+        .version    = FRAME_FILE_VERSION,
+        .flags      = isHashOnly ? (uint32_t) FRAME_FILE_HASH_ONLY : 0,
+        .width      = (uint32_t) width,
+        .height     = (uint32_t) height,
+        .frameStep  = (frameStep != 0) ? frameStep : 1,
+        .frameCount = 0,
+        .drawCount  = 0,
+    };
+    memcpy(header->signature, FRAME_FILE_SIGNATURE, sizeof(FRAME_FILE_SIGNATURE));
+
+    return true;
+}
+
+
+void FrameCaptureClose(FrameCapture* capture)
+{
+    if (capture->mapped == NULL)
+        return;
+
+    const size_t fileSize = sizeof(FrameFileHeader) +
+                            FrameCaptureGetHeader(capture)->frameCount * capture->frameSize;
+
+    munmap(capture->mapped, capture->mappedSize);
+    if (ftruncate(capture->fd, (off_t) fileSize) != 0)
+        LOG_PRINT(ERROR, "Can't truncate frame file.\n");
+    close(capture->fd);
+    free(capture->packedFrame);
+
+    *capture = {};
+}
+
+
+bool FrameCaptureAdd(FrameCapture* capture, VideoMemory* videoMemory)
+{
+    FrameFileHeader* header = FrameCaptureGetHeader(capture);
+    if (videoMemory->width != header->width || videoMemory->height != header->height)
+    {
+        LOG_PRINT(ERROR, "Frame %zux%zu doesn't fit frame file.\n", videoMemory->width,
+                                                                    videoMemory->height);
+        return false;
+    }
+
+    if (header->drawCount++ % header->frameStep != 0)
+        return true;
+
+    const size_t frameCapacity = (capture->mappedSize - sizeof(FrameFileHeader)) /
+                                 capture->frameSize;
+    if (header->frameCount == frameCapacity)
+    {
+        if (!FrameCaptureResize(capture, frameCapacity * 2))
+            return false;
+
+        header = FrameCaptureGetHeader(capture);
+    }
+
+    char* frame = capture->mapped + sizeof(FrameFileHeader) +
+                  header->frameCount * capture->frameSize;
+    const size_t pixelCount = videoMemory->width * videoMemory->height;
+    if (header->flags & FRAME_FILE_HASH_ONLY)
+    {
+        PixelsPack(videoMemory->pixelArray, capture->packedFrame, pixelCount);
+
+        const uint64_t hash = PixelsHash(capture->packedFrame, pixelCount);
+        memcpy(frame, &hash, sizeof(uint64_t));
+    }
+    else
+        PixelsPack(videoMemory->pixelArray, (PackedPixel*) frame, pixelCount);
+
+    header->frameCount++;
+    return true;
+}
+
+
+bool FrameFileOpen(FrameFile* frameFile, const char* fileName)
+{
+    *frameFile = {};
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd == -1)
+    {
+        LOG_PRINT(ERROR, "Can't open frame file %s.\n", fileName);
+        return false;
+    }
+
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0 || (size_t) fileStat.st_size < sizeof(FrameFileHeader))
+    {
+        close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(NULL, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        return false;
+
+    frameFile->header     = (const FrameFileHeader*) mapped;
+    frameFile->frames     = (const char*) mapped + sizeof(FrameFileHeader);
+    frameFile->mapped     = mapped;
+    frameFile->mappedSize = (size_t) fileStat.st_size;
+
+    const FrameFileHeader* header = frameFile->header;
+    frameFile->frameSize = (header->flags & FRAME_FILE_HASH_ONLY) ?
+                               sizeof(uint64_t) :
+                               (size_t) header->width * header->height * sizeof(PackedPixel);
+
+    if (memcmp(header->signature, FRAME_FILE_SIGNATURE, sizeof(FRAME_FILE_SIGNATURE)) != 0 ||
+        header->version != FRAME_FILE_VERSION ||
+        frameFile->frameSize == 0 || header->frameCount > 
+                     (frameFile->mappedSize - sizeof(FrameFileHeader)) / frameFile->frameSize)
+    {
+        LOG_PRINT(ERROR, "%s isn't frame file.\n", fileName);
+        FrameFileClose(frameFile);
+        return false;
+    }
+
+    return true;
+}
+
+
+void FrameFileClose(FrameFile* frameFile)
+{
+    if (frameFile->mapped != NULL)
+        munmap(frameFile->mapped, frameFile->mappedSize);
+
+    *frameFile = {};
+}
+
+
+bool FrameFileGetPixels(FrameFile* frameFile, size_t frameNum, Pixel* pixels)
+{
+    if (frameNum >= frameFile->header->frameCount ||
+        (frameFile->header->flags & FRAME_FILE_HASH_ONLY))
+        return false;
+
+    const size_t       pixelCount   = (size_t) frameFile->header->width * frameFile->header->height;
+    const PackedPixel* packedPixels = (const PackedPixel*) (frameFile->frames +
+                                                            frameNum * frameFile->frameSize);
+    for (size_t pixelNum = 0; pixelNum < pixelCount; pixelNum++)
+    {
+        pixels[pixelNum] = {
+            .symbol = (pixelSymbol_t) packedPixels[pixelNum].symbol,
+            .color  = (pixelColor_t)  packedPixels[pixelNum].color,
+        };
+    }
+
+    return true;
+}
+
+
+uint64_t FrameFileGetHash(FrameFile* frameFile, size_t frameNum)
+{
+    if (frameNum >= frameFile->header->frameCount)
+        return 0;
+
+    const char* frame = frameFile->frames + frameNum * frameFile->frameSize;
+    if (!(frameFile->header->flags & FRAME_FILE_HASH_ONLY))
+        return PixelsHash((const PackedPixel*) frame, 
+                          (size_t) frameFile->header->width * frameFile->header->height);
+
+    uint64_t hash = 0;
+    memcpy(&hash, frame, sizeof(uint64_t));
+    return hash;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Change size of file and map it again.
+ */
+static bool FrameCaptureResize(FrameCapture* capture, size_t frameCapacity)
+{
+    const size_t mappedSize = sizeof(FrameFileHeader) + frameCapacity * capture->frameSize;
+    if (ftruncate(capture->fd, (off_t) mappedSize) != 0)
+    {
+        LOG_PRINT(ERROR, "Can't resize frame file.\n");
+        return false;
+    }
+
+    void* mapped = mmap(NULL, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, capture->fd, 0);
+    if (mapped == MAP_FAILED)
+    {
+        LOG_PRINT(ERROR, "Can't map frame file.\n");
+        return false;
+    }
+
+    if (capture->mapped != NULL)
+        munmap(capture->mapped, capture->mappedSize);
+
+    capture->mapped     = (char*) mapped;
+    capture->mappedSize = mappedSize;
+    return true;
+}
+
+
+static inline FrameFileHeader* FrameCaptureGetHeader(FrameCapture* capture)
+{
+    return (FrameFileHeader*) capture->mapped;
+}
+
+
+static void PixelsPack(const Pixel* pixels, PackedPixel* packedPixels, size_t pixelCount)
+{
+    for (size_t pixelNum = 0; pixelNum < pixelCount; pixelNum++)
+    {
+        packedPixels[pixelNum] = {
+            .symbol = (char) pixels[pixelNum].symbol,
+            .color  = (char) pixels[pixelNum].color,
+        };
+    }
+}
+
+
+/**
+ * FNV-1a hash of packed pixels which takes 8 bytes at once. The last word is padded by zeros.
+ */
+static uint64_t PixelsHash(const PackedPixel* packedPixels, size_t pixelCount)
+{
+    const char*  bytes     = (const char*) packedPixels;
+    const size_t byteCount = pixelCount * sizeof(PackedPixel);
+
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t byteNum = 0; byteNum < byteCount; byteNum += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        memcpy(&word, bytes + byteNum, (byteCount - byteNum < sizeof(uint64_t)) ? 
+                                           byteCount - byteNum : sizeof(uint64_t));
+        hash = FnvHashAdd(hash, word);
+    }
+
+    return hash;
+}
@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "frameRenderer.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Maximal length of "\033[<number><command>".
+ */
+static const size_t ESCAPE_MAX_LENGTH = 3 + IO_NUMBER_MAX_LENGTH;
+
+/**
+ * Pixel of diff may need row movement, column movement and color before its symbol.
+ */
+static const size_t PIXEL_MAX_LENGTH = 3 * ESCAPE_MAX_LENGTH + 1;
+
+/**
+ * Color of cursor before the first pixel of frame.
+ */
+static const pixelColor_t NO_COLOR = 0;
+
+static const char COLOR_RESET[] = "\033[0m";
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool FrameRendererAllocate(FrameRenderer* renderer, size_t width, size_t height);
+
+
+static void FrameBuildFull(FrameRenderer* renderer, VideoMemory* videoMemory);
+
+
+static void FrameBuildDiff(FrameRenderer* renderer, VideoMemory* videoMemory);
+
+
+static void FrameAppend(FrameRenderer* renderer, const char* text, size_t length);
+
+
+static void FrameAppendEscape(FrameRenderer* renderer, size_t number, char command);
+
+
+static void FrameAppendPixel(FrameRenderer* renderer, const Pixel* pixel,
+                             pixelColor_t* cursorColor);
+
+
+static const char* ColorGetEscape(pixelColor_t color);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+void FrameRendererInit(FrameRenderer* renderer, drawMode_t mode, IoChannel* io)
+{
+    *renderer = {
+        .mode = mode,
+        .io   = io,
+    };
+}
+
+
+bool FrameRendererCaptureOpen(FrameRenderer* renderer, const char* fileName, size_t width,
+                              size_t height, size_t frameStep, bool isHashOnly)
+{
+    if (!FrameCaptureOpen(&renderer->capture, fileName, width, height, frameStep, isHashOnly))
+        return false;
+
+    renderer->mode = DRAW_MODE_CAPTURE;
+    return true;
+}
+
+
+void FrameRendererDelete(FrameRenderer* renderer)
+{
+    FrameCaptureClose(&renderer->capture);
+    free(renderer->lastFrame);
+    free(renderer->frame);
+
+    *renderer = {};
+}
+
+
+bool FrameRendererDraw(FrameRenderer* renderer, VideoMemory* videoMemory)
+{
+    if (renderer->mode == DRAW_MODE_CAPTURE)
+        return FrameCaptureAdd(&renderer->capture, videoMemory);
+
+    if ((renderer->frame == NULL || renderer->width  != videoMemory->width ||
+                                    renderer->height != videoMemory->height) &&
+        !FrameRendererAllocate(renderer, videoMemory->width, videoMemory->height))
+        return false;
+
+    const int outputFd = (renderer->io != NULL) ? renderer->io->outputFd : STDOUT_FILENO;
+    if (renderer->mode == DRAW_MODE_AUTO)
+        renderer->mode = isatty(outputFd) ? DRAW_MODE_DIFF : DRAW_MODE_FULL;
+
+    // Numbers printed by OUT after the last frame move it up, so it can't be changed.
+    const size_t writtenCount = (renderer->io != NULL) ? renderer->io->writtenCount : 0;
+    if (writtenCount != renderer->lastWrittenCount)
+        renderer->isLastFrameShown = false;
+
+    renderer->frameLength = 0;
+    if (renderer->mode == DRAW_MODE_DIFF && renderer->isLastFrameShown)
+        FrameBuildDiff(renderer, videoMemory);
+    else
+        FrameBuildFull(renderer, videoMemory);
+
+    memcpy(renderer->lastFrame, videoMemory->pixelArray, 
+           videoMemory->width * videoMemory->height * sizeof(Pixel));
+    renderer->isLastFrameShown = true;
+    renderer->lastWrittenCount = writtenCount;
+
+    if (renderer->frameLength == 0)
+        return true;
+
+    // Output which is printed before DRAW must be before the frame.
+    if (renderer->io != NULL ? !IoChannelFlush(renderer->io) : fflush(stdout) != 0)
+        return false;
+
+    return IoWrite(outputFd, renderer->frame, renderer->frameLength);
+}
+
+
+bool DrawModeFromString(const char* string, drawMode_t* drawModeBuffer)
+{
+    if (strcmp(string, "auto") == 0)
+    {
+        *drawModeBuffer = DRAW_MODE_AUTO;
+        return true;
+    }
+
+    if (strcmp(string, "full") == 0)
+    {
+        *drawModeBuffer = DRAW_MODE_FULL;
+        return true;
+    }
+
+    if (strcmp(string, "diff") == 0)
+    {
+        *drawModeBuffer = DRAW_MODE_DIFF;
+        return true;
+    }
+
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Allocate buffers for frames of this size, the last frame is forgotten.
+ */
+static bool FrameRendererAllocate(FrameRenderer* renderer, size_t width, size_t height)
+{
+    // Every pixel, '\n' of every row, movement under the frame, '\r' and color reset.
+    const size_t frameCapacity = width * height * PIXEL_MAX_LENGTH + height +
+                                 2 * ESCAPE_MAX_LENGTH + 1;
+
+    free(renderer->lastFrame);
+    free(renderer->frame);
+
+    renderer->lastFrame        = (Pixel*) calloc(width * height, sizeof(Pixel));
+    renderer->frame            = (char*)  calloc(frameCapacity,  sizeof(char));
+    renderer->width            = width;
+    renderer->height           = height;
+    renderer->isLastFrameShown = false;
+    if (renderer->lastFrame == NULL || renderer->frame == NULL)
+    {
+        LOG_PRINT(ERROR, "Can't allocate frame.\n");
+        free(renderer->lastFrame);
+        free(renderer->frame);
+        renderer->lastFrame = NULL;
+        renderer->frame     = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Every row of pixels is printed on a new line. Color is changed only between runs
+ * of pixels with different colors.
+ */
+static void FrameBuildFull(FrameRenderer* renderer, VideoMemory* videoMemory)
+{
+    const size_t width = videoMemory->width;
+
+    pixelColor_t cursorColor = NO_COLOR;
+    for (size_t y = 0; y < videoMemory->height; y++)
+    {
+        for (size_t x = 0; x < width; x++)
+            FrameAppendPixel(renderer, videoMemory->pixelArray + y * width + x, &cursorColor);
+
+        FrameAppend(renderer, "\n", 1);
+    }
+
+    if (cursorColor != NO_COLOR)
+        FrameAppend(renderer, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+}
+
+
+/**
+ * Cursor is under the last frame at the beginning of line. It is moved only to changed
+ * pixels which aren't after previous printed pixel and is returned back at the end.
+ * Nothing is built if there are no changes.
+ */
+static void FrameBuildDiff(FrameRenderer* renderer, VideoMemory* videoMemory)
+{
+    const size_t width  = videoMemory->width;
+    const size_t height = videoMemory->height;
+
+    pixelColor_t cursorColor = NO_COLOR;
+    size_t       cursorX     = 0;
+    size_t       cursorY     = height;
+    for (size_t y = 0; y < height; y++)
+    {
+        for (size_t x = 0; x < width; x++)
+        {
+            const Pixel* pixel     = videoMemory->pixelArray + y * width + x;
+            const Pixel* lastPixel = renderer->lastFrame     + y * width + x;
+            if (pixel->symbol == lastPixel->symbol && pixel->color == lastPixel->color)
+                continue;
+
+            if (cursorY != y)
+            {
+                // Cursor up or down.
+                FrameAppendEscape(renderer, (cursorY > y) ? cursorY - y : y - cursorY,
+                                            (cursorY > y) ? 'A'         : 'B');
+                cursorY = y;
+            }
+
+            if (cursorX != x)
+            {
+                // Columns are numbered from 1.
+                FrameAppendEscape(renderer, x + 1, 'G');
+                cursorX = x;
+            }
+
+            FrameAppendPixel(renderer, pixel, &cursorColor);
+            cursorX++;
+        }
+    }
+
+    if (renderer->frameLength == 0)
+        return;
+
+    FrameAppendEscape(renderer, height - cursorY, 'B');
+    FrameAppend(renderer, "\r", 1);
+
+    if (cursorColor != NO_COLOR)
+        FrameAppend(renderer, COLOR_RESET, sizeof(COLOR_RESET) - 1);
+}
+
+
+static void FrameAppend(FrameRenderer* renderer, const char* text, size_t length)
+{
+    memcpy(renderer->frame + renderer->frameLength, text, length);
+    renderer->frameLength += length;
+}
+
+
+static void FrameAppendEscape(FrameRenderer* renderer, size_t number, char command)
+{
+    FrameAppend(renderer, "\033[", 2);
+    renderer->frameLength += IoNumberFormat((int64_t) number,
+                                            renderer->frame + renderer->frameLength);
+    FrameAppend(renderer, &command, 1);
+}
+
+
+/**
+ * @param cursorColor Color of the last printed pixel, it is changed if pixel has other color.
+ */
+static void FrameAppendPixel(FrameRenderer* renderer, const Pixel* pixel,
+                             pixelColor_t* cursorColor)
+{
+    if (pixel->color != *cursorColor)
+    {
+        const char* colorEscape = ColorGetEscape(pixel->color);
+        FrameAppend(renderer, colorEscape, strlen(colorEscape));
+        *cursorColor = pixel->color;
+    }
+
+    const char symbol = (char) pixel->symbol;
+    FrameAppend(renderer, &symbol, 1);
+}
+
+
+/**
+ * Pixels with unknown colors are white.
+ */
+static const char* ColorGetEscape(pixelColor_t color)
+{
+    switch (color)
+    {
+    case PIXEL_COLOR_YELLOW:
+        return "\033[33m";
+
+    case PIXEL_COLOR_GREEN:
+        return "\033[32m";
+
+    case PIXEL_COLOR_RED:
+        return "\033[31m";
+
+    case PIXEL_COLOR_WHITE:
+    default:
+        return "\033[37m";
+    }
+}
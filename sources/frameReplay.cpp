@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "frameCapture.h"
+#include "frameRenderer.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static const size_t DEFAULT_PPM_SCALE = 8;
+
+/**
+ * Maximal length of PPM file name suffix: frame number and extension.
+ */
+static const size_t PPM_SUFFIX_MAX_LENGTH = 32;
+
+
+struct ReplayOptions
+{
+    const char* frameFileName;
+    size_t      delayMilliseconds;      /**< Pause between frames on terminal.              */
+    const char* ppmPrefix;              /**< Frames are written to PPM files if it isn't NULL. */
+    size_t      ppmScale;               /**< Side of square of every pixel in PPM.          */
+    bool        isHashPrint;            /**< Print hashes of frames instead of frames.      */
+};
+
+
+struct RgbColor
+{
+    unsigned char red;
+    unsigned char green;
+    unsigned char blue;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool OptionsParse(ReplayOptions* options, int argc, char** argv);
+
+
+static const char* OptionGetValue(const char* arg, const char* optionName);
+
+
+static bool OptionGetNumber(const char* optionValue, size_t* numberBuffer);
+
+
+static void UsagePrint(const char* executableName);
+
+
+static void HashesPrint(FrameFile* frameFile);
+
+
+static bool FramesDraw(FrameFile* frameFile, size_t delayMilliseconds);
+
+
+static bool FramesWritePpm(FrameFile* frameFile, const char* ppmPrefix, size_t ppmScale);
+
+
+static bool FrameWritePpm(VideoMemory* videoMemory, const char* fileName, size_t ppmScale);
+
+
+static RgbColor PixelGetRgb(const Pixel* pixel);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+int main(int argc, char** argv)
+{
+    ReplayOptions options = {};
+    if (!OptionsParse(&options, argc, argv))
+    {
+        UsagePrint(argv[0]);
+        return 1;
+    }
+
+    LOG_OPEN();
+
+    FrameFile frameFile = {};
+    if (!FrameFileOpen(&frameFile, options.frameFileName))
+    {
+        ColoredPrintf(RED, "Can't read frame file %s.\n", options.frameFileName);
+        LOG_CLOSE();
+        return 1;
+    }
+
+    bool isReplayed = true;
+    if (options.isHashPrint || (frameFile.header->flags & FRAME_FILE_HASH_ONLY))
+        HashesPrint(&frameFile);
+    else if (options.ppmPrefix != NULL)
+        isReplayed = FramesWritePpm(&frameFile, options.ppmPrefix, options.ppmScale);
+    else
+        isReplayed = FramesDraw(&frameFile, options.delayMilliseconds);
+
+    if (!isReplayed)
+        ColoredPrintf(RED, "Replaying failed\n");
+
+    FrameFileClose(&frameFile);
+    LOG_CLOSE();
+    return isReplayed ? 0 : 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool OptionsParse(ReplayOptions* options, int argc, char** argv)
+{
+    *options = {.ppmScale = DEFAULT_PPM_SCALE};
+
+    for (int argNum = 1; argNum < argc; argNum++)
+    {
+        const char* arg         = argv[argNum];
+        const char* optionValue = NULL;
+
+        if ((optionValue = OptionGetValue(arg, "--delay=")) != NULL)
+        {
+            if (!OptionGetNumber(optionValue, &options->delayMilliseconds))
+                return false;
+        }
+        else if ((optionValue = OptionGetValue(arg, "--ppm=")) != NULL)
+            options->ppmPrefix = optionValue;
+        else if ((optionValue = OptionGetValue(arg, "--scale=")) != NULL)
+        {
+            if (!OptionGetNumber(optionValue, &options->ppmScale) || options->ppmScale == 0)
+                return false;
+        }
+        else if (strcmp(arg, "--hashes") == 0)
+            options->isHashPrint = true;
+        else if (arg[0] != '-' && options->frameFileName == NULL)
+            options->frameFileName = arg;
+        else
+            return false;
+    }
+
+    return options->frameFileName != NULL;
+}
+
+
+static const char* OptionGetValue(const char* arg, const char* optionName)
+{
+    const size_t optionNameLength = strlen(optionName);
+    if (strncmp(arg, optionName, optionNameLength) != 0)
+        return NULL;
+
+    return arg + optionNameLength;
+}
+
+
+static bool OptionGetNumber(const char* optionValue, size_t* numberBuffer)
+{
+    char* valueEnd = NULL;
+    *numberBuffer  = strtoul(optionValue, &valueEnd, 10);
+
+    return *optionValue != '\0' && *valueEnd == '\0';
+}
+
+
+static void UsagePrint(const char* executableName)
+{
+    ColoredPrintf(RED, "Usage: %s [options] frames.bin\n"
+                       "Options:\n"
+                       "\t--delay=MS      pause between frames on terminal\n"
+                       "\t--ppm=PREFIX    write frames to PREFIX000000.ppm, ...\n"
+                       "\t--scale=N       side of every pixel in PPM, default is %zu\n"
+                       "\t--hashes        print hashes of frames\n",
+                  executableName, DEFAULT_PPM_SCALE);
+}
+
+
+static void HashesPrint(FrameFile* frameFile)
+{
+    const FrameFileHeader* header = frameFile->header;
+    printf("draws: %lu, frames: %lu, step: %lu\n", header->drawCount, header->frameCount,
+                                                   header->frameStep);
+
+    for (size_t frameNum = 0; frameNum < header->frameCount; frameNum++)
+        printf("%zu %016lx\n", frameNum, FrameFileGetHash(frameFile, frameNum));
+}
+
+
+/**
+ * Frames are drawn by renderer of DRAW, so only changes are printed on terminal.
+ */
+static bool FramesDraw(FrameFile* frameFile, size_t delayMilliseconds)
+{
+    VideoMemory videoMemory = {};
+    if (!VideoMemoryInit(&videoMemory, frameFile->header->width, frameFile->header->height))
+        return false;
+
+    FrameRenderer renderer = {};
+    FrameRendererInit(&renderer, DRAW_MODE_AUTO, NULL);
+
+    bool isDrawn = true;
+    for (size_t frameNum = 0; isDrawn && frameNum < frameFile->header->frameCount; frameNum++)
+    {
+        isDrawn = FrameFileGetPixels(frameFile, frameNum, videoMemory.pixelArray) &&
+                  FrameRendererDraw(&renderer, &videoMemory);
+
+        if (delayMilliseconds != 0)
+            usleep((useconds_t) (delayMilliseconds * 1000));
+    }
+
+    FrameRendererDelete(&renderer);
+    VideoMemoryDelete(&videoMemory);
+    return isDrawn;
+}
+
+
+static bool FramesWritePpm(FrameFile* frameFile, const char* ppmPrefix, size_t ppmScale)
+{
+    const size_t fileNameLength = strlen(ppmPrefix) + PPM_SUFFIX_MAX_LENGTH;
+    char*        fileName       = (char*) calloc(fileNameLength, sizeof(char));
+    VideoMemory  videoMemory    = {};
+    if (fileName == NULL ||
+        !VideoMemoryInit(&videoMemory, frameFile->header->width, frameFile->header->height))
+    {
+        free(fileName);
+        return false;
+    }
+
+    bool isWritten = true;
+    for (size_t frameNum = 0; isWritten && frameNum < frameFile->header->frameCount; frameNum++)
+    {
+        snprintf(fileName, fileNameLength, "%s%06zu.ppm", ppmPrefix, frameNum);
+        isWritten = FrameFileGetPixels(frameFile, frameNum, videoMemory.pixelArray) &&
+                    FrameWritePpm(&videoMemory, fileName, ppmScale);
+    }
+
+    VideoMemoryDelete(&videoMemory);
+    free(fileName);
+    return isWritten;
+}
+
+
+/**
+ * Every pixel is square of its color, pixels with spaces are black.
+ */
+static bool FrameWritePpm(VideoMemory* videoMemory, const char* fileName, size_t ppmScale)
+{
+    const size_t width  = videoMemory->width;
+    const size_t height = videoMemory->height;
+
+    FILE* ppmFile = fopen(fileName, "wb");
+    if (ppmFile == NULL)
+    {
+        LOG_PRINT(ERROR, "Can't open %s.\n", fileName);
+        return false;
+    }
+
+    const size_t rowLength = width * ppmScale;
+    RgbColor*    row       = (RgbColor*) calloc(rowLength, sizeof(RgbColor));
+    if (row == NULL)
+    {
+        fclose(ppmFile);
+        return false;
+    }
+
+    fprintf(ppmFile, "P6\n%zu %zu\n255\n", rowLength, height * ppmScale);
+
+    bool isWritten = true;
+    for (size_t y = 0; isWritten && y < height; y++)
+    {
+        for (size_t x = 0; x < width; x++)
+        {
+            const RgbColor color = PixelGetRgb(videoMemory->pixelArray + y * width + x);
+            for (size_t pointNum = 0; pointNum < ppmScale; pointNum++)
+                row[x * ppmScale + pointNum] = color;
+        }
+
+        for (size_t lineNum = 0; isWritten && lineNum < ppmScale; lineNum++)
+            isWritten = fwrite(row, sizeof(RgbColor), rowLength, ppmFile) == rowLength;
+    }
+
+    free(row);
+    return fclose(ppmFile) == 0 && isWritten;
+}
+
+
+static RgbColor PixelGetRgb(const Pixel* pixel)
+{
+    if (pixel->symbol == ' ' || pixel->symbol == '\0')
+        return {0, 0, 0};
+
+    switch (pixel->color)
+    {
+    case PIXEL_COLOR_YELLOW:
+        return {255, 255, 0};
+
+    case PIXEL_COLOR_GREEN:
+        return {0, 255, 0};
+
+    case PIXEL_COLOR_RED:
+        return {255, 0, 0};
+
+    case PIXEL_COLOR_WHITE:
+    default:
+        return {255, 255, 255};
+    }
+}
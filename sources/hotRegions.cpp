@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "hotRegions.h"
+#include "virtualMachine.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static const size_t HOT_REGIONS_MIN_CAPACITY = 16;
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool HotRegionsInit(HotRegions* hotRegions, size_t codeSize, size_t threshold)
+{
+    *hotRegions = {};
+
+    hotRegions->transferCounts = (size_t*) calloc(codeSize + 1, sizeof(size_t));
+    hotRegions->regionNums     = (size_t*) calloc(codeSize + 1, sizeof(size_t));
+    if (hotRegions->transferCounts == NULL || hotRegions->regionNums == NULL)
+    {
+        HotRegionsDelete(hotRegions);
+        return false;
+    }
+
+    hotRegions->codeSize  = codeSize;
+    hotRegions->threshold = (threshold == 0) ? HOT_REGION_DEFAULT_THRESHOLD : threshold;
+
+    return true;
+}
+
+
+void HotRegionsDelete(HotRegions* hotRegions)
+{
+    free(hotRegions->transferCounts);
+    free(hotRegions->regionNums);
+    free(hotRegions->regions);
+
+    *hotRegions = {};
+}
+
+
+HotRegion* HotRegionsAdd(HotRegions* hotRegions, size_t headerNum, size_t endNum, 
+                         bool isCallTarget, double tierUpSeconds)
+{
+    if (headerNum >= hotRegions->codeSize)
+        return NULL;
+
+    if (hotRegions->regionCount == hotRegions->regionCapacity)
+    {
+        size_t newCapacity = hotRegions->regionCapacity * 2;
+        if (newCapacity < HOT_REGIONS_MIN_CAPACITY)
+            newCapacity = HOT_REGIONS_MIN_CAPACITY;
+
+        HotRegion* newRegions = (HotRegion*) realloc(hotRegions->regions, 
+                                                     newCapacity * sizeof(HotRegion));
+        if (newRegions == NULL)
+            return NULL;
+
+        hotRegions->regions        = newRegions;
+        hotRegions->regionCapacity = newCapacity;
+    }
+
+    HotRegion* region = hotRegions->regions + hotRegions->regionCount++;
+    *region = {
+        .headerNum     = headerNum,
+        .endNum        = endNum,
+        .isCallTarget  = isCallTarget,
+        .tierUpSeconds = tierUpSeconds,
+    };
+    hotRegions->regionNums[headerNum] = hotRegions->regionCount;
+
+    LOG_PRINT(INFO, "Tier-up: %s [%zu, %zu) at %.6lf s\n", 
+              isCallTarget ? "function" : "loop", headerNum, endNum, tierUpSeconds);
+    return region;
+}
+
+
+void HotRegionsPrint(HotRegions* hotRegions, double executionSeconds)
+{
+    const double interpreterSeconds = executionSeconds - hotRegions->tierUpSeconds - 
+                                                         hotRegions->fastTierSeconds;
+
+    ColoredPrintf(GREEN, "Tiers: interpreter %.6lf s, tier-up %.6lf s, fused %.6lf s\n",
+                  interpreterSeconds, hotRegions->tierUpSeconds, hotRegions->fastTierSeconds);
+
+    for (size_t regionNum = 0; regionNum < hotRegions->regionCount; regionNum++)
+    {
+        HotRegion* region = hotRegions->regions + regionNum;
+
+        ColoredPrintf(GREEN, "\t%-8s [%zu, %zu): tier-up at %.6lf s, %zu transfers, "
+                             "%zu enters, %zu fused instructions\n",
+                      region->isCallTarget ? "function" : "loop", 
+                      region->headerNum, region->endNum, region->tierUpSeconds,
+                      hotRegions->transferCounts[region->headerNum], 
+                      region->enterCount, region->executedCount);
+    }
+}
@@ -0,0 +1,329 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "ioChannel.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Two digits of every number from 0 to 99, so number is formatted by pairs of digits.
+ */
+static const char DIGIT_PAIRS[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool IoChannelReadText(IoChannel* channel, int64_t* valueBuffer);
+
+
+static bool IoChannelReadBinary(IoChannel* channel, int64_t* valueBuffer);
+
+
+static bool InputPeek(IoChannel* channel, char* charBuffer);
+
+
+static bool InputFill(IoChannel* channel);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool IoChannelInit(IoChannel* channel, ioMode_t mode, int inputFd, int outputFd)
+{
+    *channel = {
+        .mode     = mode,
+        .inputFd  = inputFd,
+        .outputFd = outputFd,
+    };
+
+    if (mode == IO_MODE_COLORED)
+        return true;
+
+    channel->inputBuffer  = (char*) calloc(IO_BUFFER_CAPACITY, sizeof(char));
+    channel->outputBuffer = (char*) calloc(IO_BUFFER_CAPACITY, sizeof(char));
+    if (channel->inputBuffer == NULL || channel->outputBuffer == NULL)
+    {
+        IoChannelDelete(channel);
+        return false;
+    }
+
+    return true;
+}
+
+
+void IoChannelDelete(IoChannel* channel)
+{
+    IoChannelFlush(channel);
+
+    free(channel->inputBuffer);
+    free(channel->outputBuffer);
+
+    *channel = {};
+}
+
+
+bool IoChannelRead(IoChannel* channel, int64_t* valueBuffer)
+{
+    switch (channel->mode)
+    {
+    case IO_MODE_COLORED:
+        return scanf("%ld", valueBuffer) > 0;
+
+    case IO_MODE_TEXT:
+        return IoChannelReadText(channel, valueBuffer);
+
+    case IO_MODE_BINARY:
+        return IoChannelReadBinary(channel, valueBuffer);
+
+    default:
+        LOG_PRINT(ERROR, "Wrong ioMode = %d\n", channel->mode);
+        return false;
+    }
+}
+
+
+bool IoChannelWrite(IoChannel* channel, int64_t value)
+{
+    channel->writtenCount++;
+
+    switch (channel->mode)
+    {
+    case IO_MODE_COLORED:
+        ColoredPrintf(YELLOW, "%ld\n", value);
+        return true;
+
+    case IO_MODE_TEXT:
+        // +1 for '\n'
+        if (IO_BUFFER_CAPACITY - channel->outputLength < IO_NUMBER_MAX_LENGTH + 1 &&
+            !IoChannelFlush(channel))
+            return false;
+
+        channel->outputLength += IoNumberFormat(value, channel->outputBuffer +
+                                                       channel->outputLength);
+        channel->outputBuffer[channel->outputLength++] = '\n';
+        return true;
+
+    case IO_MODE_BINARY:
+        if (IO_BUFFER_CAPACITY - channel->outputLength < sizeof(int64_t) &&
+            !IoChannelFlush(channel))
+            return false;
+
+        memcpy(channel->outputBuffer + channel->outputLength, &value, sizeof(int64_t));
+        channel->outputLength += sizeof(int64_t);
+        return true;
+
+    default:
+        LOG_PRINT(ERROR, "Wrong ioMode = %d\n", channel->mode);
+        return false;
+    }
+}
+
+
+bool IoChannelFlush(IoChannel* channel)
+{
+    // Output of stdio (colored numbers, DRAW, errors) is written before buffered numbers.
+    if (fflush(stdout) != 0)
+        return false;
+
+    if (!IoWrite(channel->outputFd, channel->outputBuffer, channel->outputLength))
+        return false;
+
+    channel->outputLength = 0;
+    return true;
+}
+
+
+bool IoWrite(int fd, const char* buffer, size_t length)
+{
+    size_t writtenLength = 0;
+    while (writtenLength < length)
+    {
+        ssize_t writeResult = write(fd, buffer + writtenLength, length - writtenLength);
+        if (writeResult < 0 && errno == EINTR)
+            continue;
+
+        if (writeResult <= 0)
+        {
+            LOG_PRINT(ERROR, "Can't write output to fd = %d.\n", fd);
+            return false;
+        }
+
+        writtenLength += (size_t) writeResult;
+    }
+
+    return true;
+}
+
+
+bool IoModeFromString(const char* string, ioMode_t* ioModeBuffer)
+{
+    if (strcmp(string, "colored") == 0)
+    {
+        *ioModeBuffer = IO_MODE_COLORED;
+        return true;
+    }
+
+    if (strcmp(string, "text") == 0)
+    {
+        *ioModeBuffer = IO_MODE_TEXT;
+        return true;
+    }
+
+    if (strcmp(string, "binary") == 0)
+    {
+        *ioModeBuffer = IO_MODE_BINARY;
+        return true;
+    }
+
+    return false;
+}
+
+
+size_t IoNumberFormat(int64_t value, char* buffer)
+{
+    char   digits[IO_NUMBER_MAX_LENGTH] = {};
+    size_t digitsBegin = IO_NUMBER_MAX_LENGTH;
+
+    // Magnitude is unsigned, so INT64_MIN has it too.
+    uint64_t magnitude = (value < 0) ? 0 - (uint64_t) value : (uint64_t) value;
+    while (magnitude >= 100)
+    {
+        const uint64_t pairNum = magnitude % 100 * 2;
+        magnitude /= 100;
+
+        digits[--digitsBegin] = DIGIT_PAIRS[pairNum + 1];
+        digits[--digitsBegin] = DIGIT_PAIRS[pairNum];
+    }
+
+    if (magnitude >= 10)
+    {
+        digits[--digitsBegin] = DIGIT_PAIRS[magnitude * 2 + 1];
+        digits[--digitsBegin] = DIGIT_PAIRS[magnitude * 2];
+    }
+    else
+        digits[--digitsBegin] = (char) ('0' + magnitude);
+
+    if (value < 0)
+        digits[--digitsBegin] = '-';
+
+    const size_t length = IO_NUMBER_MAX_LENGTH - digitsBegin;
+    memcpy(buffer, digits + digitsBegin, length);
+
+    return length;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Same format as scanf("%ld"): spaces, optional sign and digits.
+ */
+static bool IoChannelReadText(IoChannel* channel, int64_t* valueBuffer)
+{
+    char nextChar = 0;
+    while (true)
+    {
+        if (!InputPeek(channel, &nextChar))
+            return false;
+
+        if (!isspace(nextChar))
+            break;
+
+        channel->inputBegin++;
+    }
+
+    const bool isNegative = (nextChar == '-');
+    if (nextChar == '-' || nextChar == '+')
+        channel->inputBegin++;
+
+    uint64_t magnitude  = 0;
+    size_t   digitCount = 0;
+    while (InputPeek(channel, &nextChar) && isdigit(nextChar))
+    {
+        magnitude = magnitude * 10 + (uint64_t) (nextChar - '0');
+        digitCount++;
+        channel->inputBegin++;
+    }
+
+    if (digitCount == 0)
+        return false;
+
+    *valueBuffer = (int64_t) (isNegative ? 0 - magnitude : magnitude);
+    return true;
+}
+
+
+static bool IoChannelReadBinary(IoChannel* channel, int64_t* valueBuffer)
+{
+    char   valueBytes[sizeof(int64_t)] = {};
+    size_t byteCount = 0;
+    while (byteCount < sizeof(int64_t))
+    {
+        if (channel->inputBegin == channel->inputEnd && !InputFill(channel))
+            return false;
+
+        size_t copiedCount = channel->inputEnd - channel->inputBegin;
+        if (copiedCount > sizeof(int64_t) - byteCount)
+            copiedCount = sizeof(int64_t) - byteCount;
+
+        memcpy(valueBytes + byteCount, channel->inputBuffer + channel->inputBegin, copiedCount);
+        channel->inputBegin += copiedCount;
+        byteCount           += copiedCount;
+    }
+
+    memcpy(valueBuffer, valueBytes, sizeof(int64_t));
+    return true;
+}
+
+
+static bool InputPeek(IoChannel* channel, char* charBuffer)
+{
+    if (channel->inputBegin == channel->inputEnd && !InputFill(channel))
+        return false;
+
+    *charBuffer = channel->inputBuffer[channel->inputBegin];
+    return true;
+}
+
+
+/**
+ * Read next part of input to empty buffer.
+ */
+static bool InputFill(IoChannel* channel)
+{
+    if (channel->isInputEnded)
+        return false;
+
+    ssize_t readResult = 0;
+    do
+        readResult = read(channel->inputFd, channel->inputBuffer, IO_BUFFER_CAPACITY);
+    while (readResult < 0 && errno == EINTR);
+
+    if (readResult <= 0)
+    {
+        channel->isInputEnded = true;
+        return false;
+    }
+
+    channel->inputBegin = 0;
+    channel->inputEnd   = (size_t) readResult;
+    return true;
+}
@@ -0,0 +1,827 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/mman.h>
+
+#include "jit.h"
+#include "virtualMachine.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Numbers of x86-64 registers as they are written in ModRM and REX.
+ */
+enum HOST_REGISTERS
+{
+    HOST_RAX = 0,
+    HOST_RCX = 1,
+    HOST_RDX = 2,
+    HOST_RBX = 3,
+    HOST_RSP = 4,
+    HOST_RBP = 5,
+    HOST_RSI = 6,
+    HOST_RDI = 7,
+    HOST_R12 = 12,
+    HOST_R13 = 13,
+    HOST_R14 = 14,
+    HOST_R15 = 15,
+};
+typedef enum HOST_REGISTERS hostRegister_t;
+
+
+/**
+ * Registers of virtual machine live in callee-saved registers,
+ * so calls to runtime don't spoil them.
+ */
+static const hostRegister_t PINNED_REGISTERS[] = {HOST_R12, HOST_R13, HOST_R14, HOST_R15};
+static const size_t PINNED_REGISTER_COUNT = sizeof(PINNED_REGISTERS) / sizeof(PINNED_REGISTERS[0]);
+
+static const hostRegister_t RAM_BASE_REGISTER      = HOST_RBX;
+static const hostRegister_t OPERAND_STACK_REGISTER = HOST_RBP;  /**< Points to top element. */
+
+
+static const size_t JIT_PROLOGUE_MAX_SIZE    = 128;
+static const size_t JIT_EPILOGUE_MAX_SIZE    = 128;
+static const size_t JIT_INSTRUCTION_MAX_SIZE = 64;
+
+
+/**
+ * Jump targets after the last decoded instruction.
+ */
+enum JIT_SPECIAL_TARGETS
+{
+    JIT_TARGET_FINISH,  /**< Program is finished.  */
+    JIT_TARGET_FAIL,    /**< Program is failed.    */
+    JIT_SPECIAL_TARGET_COUNT
+};
+
+
+struct JitFixup
+{
+    size_t   rel32Offset;   /**< Offset of rel32 field in code.    */
+    uint32_t target;        /**< Number of decoded instruction.    */
+};
+
+
+struct JitEmitter
+{
+    uint8_t*  code;
+    size_t    size;
+
+    size_t*   targetOffsets;    /**< Native offset of every decoded instruction and special 
+                                     target.                                                */
+    JitFixup* fixups;
+    size_t    fixupCount;
+};
+
+
+typedef int (*JitFunction_t)();
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool JitIsSupported(DecodedCode* decodedCode);
+
+
+static bool InstructionCompile(JitCode* jitCode, JitEmitter* emitter,
+                               DecodedInstruction* instruction, size_t instructionCount, RAM* ram,
+                               IoChannel* io, FrameRenderer* renderer);
+
+
+static void PrologueCompile(JitCode* jitCode, JitEmitter* emitter, Registers64* registers, 
+                            RAM* ram);
+
+
+static void EpilogueCompile(JitEmitter* emitter, size_t instructionCount, Registers64* registers);
+
+
+static void FixupsResolve(JitEmitter* emitter);
+
+
+static JitFunction_t CodeGetFunction(uint8_t* code);
+
+
+template <typename Function>
+static uint64_t FunctionGetAddress(Function* function);
+
+
+static int64_t JitSqrt(int64_t arg);
+static int64_t JitSin(int64_t arg);
+static int64_t JitCos(int64_t arg);
+
+
+static void EmitByte(JitEmitter* emitter, uint8_t byte);
+static void EmitUint32(JitEmitter* emitter, uint32_t value);
+static void EmitUint64(JitEmitter* emitter, uint64_t value);
+static void EmitRex(JitEmitter* emitter, int reg, int rm);
+static void EmitModRm(JitEmitter* emitter, int mod, int reg, int rm);
+
+static void EmitMovRegImm(JitEmitter* emitter, int reg, uint64_t immediate);
+static void EmitMovRegReg(JitEmitter* emitter, int destination, int source);
+static void EmitAluRegReg(JitEmitter* emitter, uint8_t opcode, int destination, int source);
+static void EmitImulRegReg(JitEmitter* emitter, int destination, int source);
+static void EmitLoad(JitEmitter* emitter, int destination, int base, int8_t displacement);
+static void EmitStore(JitEmitter* emitter, int base, int8_t displacement, int source);
+static void EmitPushHost(JitEmitter* emitter, int reg);
+static void EmitPopHost(JitEmitter* emitter, int reg);
+static void EmitCall(JitEmitter* emitter, uint64_t functionAddress);
+static void EmitJump(JitEmitter* emitter, uint8_t conditionCode, uint32_t target);
+
+static void EmitOperandPush(JitEmitter* emitter, int reg);
+static void EmitOperandPop(JitEmitter* emitter, int reg);
+static void EmitAddressCompute(JitEmitter* emitter, DecodedInstruction* instruction,
+                               bool isRegister, bool isConst);
+static void EmitRamLoad(JitEmitter* emitter, size_t ramSize);
+static void EmitRamStore(JitEmitter* emitter, size_t ramSize);
+
+
+/**
+ * Opcodes of instructions which are used by JIT.
+ */
+static const uint8_t ALU_ADD = 0x01;
+static const uint8_t ALU_SUB = 0x29;
+static const uint8_t ALU_CMP = 0x39;
+
+static const uint8_t JCC_ALWAYS = 0xff;   /**< Not a real condition code, means JMP. */
+static const uint8_t JCC_AE     = 0x83;
+static const uint8_t JCC_E      = 0x84;
+static const uint8_t JCC_NE     = 0x85;
+static const uint8_t JCC_L      = 0x8c;
+static const uint8_t JCC_GE     = 0x8d;
+static const uint8_t JCC_LE     = 0x8e;
+static const uint8_t JCC_G      = 0x8f;
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool JitCodeInit(JitCode* jitCode, DecodedCode* decodedCode, Registers64* registers, RAM* ram,
+                 IoChannel* io, FrameRenderer* renderer, size_t operandStackCapacity)
+{
+    *jitCode = {};
+
+    if (!JitIsSupported(decodedCode))
+        return false;
+
+    const size_t instructionCount = decodedCode->instructionCount;
+    const size_t codeCapacity     = JIT_PROLOGUE_MAX_SIZE + JIT_EPILOGUE_MAX_SIZE +
+                                    instructionCount * JIT_INSTRUCTION_MAX_SIZE;
+
+    void* code = mmap(NULL, codeCapacity, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (code == MAP_FAILED)
+        return false;
+
+    jitCode->code         = (uint8_t*) code;
+    jitCode->codeCapacity = codeCapacity;
+    jitCode->operandStack = (instruction_t*) calloc(operandStackCapacity, sizeof(instruction_t));
+    jitCode->callStack    = (uint8_t**)      calloc(JIT_CALL_STACK_CAPACITY, sizeof(uint8_t*));
+    jitCode->callStackTop = jitCode->callStack;
+
+    JitEmitter emitter    = {.code = jitCode->code};
+    emitter.targetOffsets = (size_t*)   calloc(instructionCount + JIT_SPECIAL_TARGET_COUNT,
+                                               sizeof(size_t));
+    emitter.fixups        = (JitFixup*) calloc(instructionCount * 2 + 1, sizeof(JitFixup));
+
+    if (jitCode->operandStack == NULL || jitCode->callStack == NULL ||
+        emitter.targetOffsets == NULL || emitter.fixups    == NULL)
+    {
+        free(emitter.targetOffsets);
+        free(emitter.fixups);
+        JitCodeDelete(jitCode);
+        return false;
+    }
+
+    PrologueCompile(jitCode, &emitter, registers, ram);
+
+    for (size_t instructionNum = 0; instructionNum < instructionCount; instructionNum++)
+    {
+        emitter.targetOffsets[instructionNum] = emitter.size;
+
+        if (!InstructionCompile(jitCode, &emitter, decodedCode->instructions + instructionNum,
+                                instructionCount, ram, io, renderer))
+        {
+            free(emitter.targetOffsets);
+            free(emitter.fixups);
+            JitCodeDelete(jitCode);
+            return false;
+        }
+    }
+
+    EpilogueCompile(&emitter, instructionCount, registers);
+    FixupsResolve(&emitter);
+
+    free(emitter.targetOffsets);
+    free(emitter.fixups);
+
+    if (mprotect(jitCode->code, jitCode->codeCapacity, PROT_READ | PROT_EXEC) != 0)
+    {
+        JitCodeDelete(jitCode);
+        return false;
+    }
+
+    LOG_PRINT(INFO, "JIT: %zu decoded instructions -> %zu bytes of native code.\n",
+              instructionCount, emitter.size);
+    return true;
+}
+
+
+bool JitCodeRun(JitCode* jitCode)
+{
+    jitCode->callStackTop = jitCode->callStack;
+
+    JitFunction_t function = CodeGetFunction(jitCode->code);
+    return function() != 0;
+}
+
+
+void JitCodeDelete(JitCode* jitCode)
+{
+    if (jitCode->code != NULL)
+        munmap(jitCode->code, jitCode->codeCapacity);
+
+    free(jitCode->operandStack);
+    free(jitCode->callStack);
+
+    *jitCode = {};
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool JitIsSupported(DecodedCode* decodedCode)
+{
+#if defined(__x86_64__) && defined(__linux__)
+    if (REGISTER_COUNT > PINNED_REGISTER_COUNT)
+    {
+        LOG_PRINT(INFO, "JIT: %zu registers can't be pinned to host registers.\n", REGISTER_COUNT);
+        return false;
+    }
+
+    if (decodedCode->instructionCount == 0 || decodedCode->instructions == NULL)
+        return false;
+
+    return true;
+#else
+    (void) decodedCode;
+    LOG_PRINT(INFO, "JIT: host isn't x86-64 Linux.\n");
+    return false;
+#endif
+}
+
+
+static void PrologueCompile(JitCode* jitCode, JitEmitter* emitter, Registers64* registers, 
+                            RAM* ram)
+{
+    EmitPushHost(emitter, HOST_RBX);
+    EmitPushHost(emitter, HOST_RBP);
+    EmitPushHost(emitter, HOST_R12);
+    EmitPushHost(emitter, HOST_R13);
+    EmitPushHost(emitter, HOST_R14);
+    EmitPushHost(emitter, HOST_R15);
+
+    // Return address and 6 saved registers take 56 bytes, so rsp needs 8 more to be aligned by 16.
+    EmitRex(emitter, 0, HOST_RSP);
+    EmitByte(emitter, 0x83);
+    EmitModRm(emitter, 3, 5, HOST_RSP);
+    EmitByte(emitter, 8);
+
+    EmitMovRegImm(emitter, HOST_RAX, (uint64_t) registers);
+    for (size_t registerNum = 0; registerNum < REGISTER_COUNT; registerNum++)
+        EmitLoad(emitter, PINNED_REGISTERS[registerNum], HOST_RAX,
+                 (int8_t) (registerNum * sizeof(register64_t)));
+
+    EmitMovRegImm(emitter, HOST_RAX, (uint64_t) &ram->memory);
+    EmitLoad(emitter, RAM_BASE_REGISTER, HOST_RAX, 0);
+
+    EmitMovRegImm(emitter, OPERAND_STACK_REGISTER, (uint64_t) jitCode->operandStack);
+}
+
+
+static void EpilogueCompile(JitEmitter* emitter, size_t instructionCount, Registers64* registers)
+{
+    const size_t finishOffset = emitter->size;
+    EmitByte(emitter, 0xb8);                        // mov eax, 1
+    EmitUint32(emitter, 1);
+    EmitByte(emitter, 0xeb);                        // jmp short over failure
+    EmitByte(emitter, 2);
+
+    const size_t failOffset = emitter->size;
+    EmitByte(emitter, 0x31);                        // xor eax, eax
+    EmitByte(emitter, 0xc0);
+
+    EmitMovRegImm(emitter, HOST_RDX, (uint64_t) registers);
+    for (size_t registerNum = 0; registerNum < REGISTER_COUNT; registerNum++)
+        EmitStore(emitter, HOST_RDX, (int8_t) (registerNum * sizeof(register64_t)),
+                  PINNED_REGISTERS[registerNum]);
+
+    EmitRex(emitter, 0, HOST_RSP);                  // add rsp, 8
+    EmitByte(emitter, 0x83);
+    EmitModRm(emitter, 3, 0, HOST_RSP);
+    EmitByte(emitter, 8);
+
+    EmitPopHost(emitter, HOST_R15);
+    EmitPopHost(emitter, HOST_R14);
+    EmitPopHost(emitter, HOST_R13);
+    EmitPopHost(emitter, HOST_R12);
+    EmitPopHost(emitter, HOST_RBP);
+    EmitPopHost(emitter, HOST_RBX);
+    EmitByte(emitter, 0xc3);                        // ret
+
+    emitter->targetOffsets[instructionCount + JIT_TARGET_FINISH] = finishOffset;
+    emitter->targetOffsets[instructionCount + JIT_TARGET_FAIL]   = failOffset;
+}
+
+
+static void FixupsResolve(JitEmitter* emitter)
+{
+    for (size_t fixupNum = 0; fixupNum < emitter->fixupCount; fixupNum++)
+    {
+        JitFixup* fixup = emitter->fixups + fixupNum;
+
+        int32_t rel32 = (int32_t) ((int64_t) emitter->targetOffsets[fixup->target] -
+                                   (int64_t) (fixup->rel32Offset + sizeof(int32_t)));
+        memcpy(emitter->code + fixup->rel32Offset, &rel32, sizeof(rel32));
+    }
+}
+
+
+/**
+ * Function pointer isn't converted to object pointer and back, so bytes are copied.
+ */
+static JitFunction_t CodeGetFunction(uint8_t* code)
+{
+    static_assert(sizeof(JitFunction_t) == sizeof(code), "code pointer isn't function pointer");
+
+    JitFunction_t function = NULL;
+    memcpy(&function, &code, sizeof(function));
+    return function;
+}
+
+
+template <typename Function>
+static uint64_t FunctionGetAddress(Function* function)
+{
+    static_assert(sizeof(function) == sizeof(uint64_t), "function pointer isn't 64-bit");
+
+    uint64_t address = 0;
+    memcpy(&address, &function, sizeof(address));
+    return address;
+}
+
+
+#define POPPED_OPERATION_(...)                      \
+{                                                   \
+    EmitOperandPop(emitter, HOST_RCX);              \
+    EmitOperandPop(emitter, HOST_RAX);              \
+    __VA_ARGS__;                                    \
+    EmitOperandPush(emitter, HOST_RAX);             \
+    return true;                                    \
+}
+
+#define FUNCTION_CALL_(FUNCTION)                     \
+{                                                    \
+    EmitOperandPop(emitter, HOST_RDI);               \
+    EmitCall(emitter, FunctionGetAddress(FUNCTION)); \
+    EmitOperandPush(emitter, HOST_RAX);              \
+    return true;                                     \
+}
+
+#define JUMP_IF_(CONDITION_CODE)                                        \
+{                                                                       \
+    EmitLoad(emitter, HOST_RCX, OPERAND_STACK_REGISTER, 0);             \
+    EmitLoad(emitter, HOST_RAX, OPERAND_STACK_REGISTER, -8);            \
+    EmitAluRegReg(emitter, ALU_CMP, HOST_RCX, HOST_RAX);                \
+    EmitJump(emitter, CONDITION_CODE, instruction->jumpTarget);         \
+    return true;                                                        \
+}
+
+static bool InstructionCompile(JitCode* jitCode, JitEmitter* emitter,
+                               DecodedInstruction* instruction, size_t instructionCount, RAM* ram,
+                               IoChannel* io, FrameRenderer* renderer)
+{
+    const int firstRegister = PINNED_REGISTERS[instruction->registerNum % PINNED_REGISTER_COUNT];
+    const uint32_t failTarget = (uint32_t) (instructionCount + JIT_TARGET_FAIL);
+
+    switch (instruction->cmdName)
+    {
+    case DECODED_PUSH_CONST:
+        EmitMovRegImm(emitter, HOST_RAX, (uint64_t) instruction->immediate);
+        EmitOperandPush(emitter, HOST_RAX);
+        return true;
+
+    case DECODED_PUSH_REGISTER:
+        EmitOperandPush(emitter, firstRegister);
+        return true;
+
+    case DECODED_PUSH_REGISTER_CONST:
+        EmitAddressCompute(emitter, instruction, true, true);
+        EmitOperandPush(emitter, HOST_RAX);
+        return true;
+
+    case DECODED_PUSH_RAM_CONST:
+    case DECODED_PUSH_RAM_REGISTER:
+    case DECODED_PUSH_RAM_REGISTER_CONST:
+        EmitAddressCompute(emitter, instruction,
+                           instruction->cmdName != DECODED_PUSH_RAM_CONST,
+                           instruction->cmdName != DECODED_PUSH_RAM_REGISTER);
+        EmitRamLoad(emitter, ram->size);
+        EmitOperandPush(emitter, HOST_RCX);
+        return true;
+
+    case DECODED_POP_REGISTER:
+        EmitOperandPop(emitter, firstRegister);
+        return true;
+
+    case DECODED_POP_RAM_CONST:
+    case DECODED_POP_RAM_REGISTER:
+    case DECODED_POP_RAM_REGISTER_CONST:
+        EmitOperandPop(emitter, HOST_RCX);
+        EmitAddressCompute(emitter, instruction,
+                           instruction->cmdName != DECODED_POP_RAM_CONST,
+                           instruction->cmdName != DECODED_POP_RAM_REGISTER);
+        EmitRamStore(emitter, ram->size);
+        return true;
+
+    case DECODED_ADD:
+        POPPED_OPERATION_(EmitAluRegReg(emitter, ALU_ADD, HOST_RAX, HOST_RCX));
+
+    case DECODED_SUB:
+        POPPED_OPERATION_(EmitAluRegReg(emitter, ALU_SUB, HOST_RAX, HOST_RCX));
+
+    case DECODED_MUL:
+        POPPED_OPERATION_(EmitImulRegReg(emitter, HOST_RAX, HOST_RCX));
+
+    case DECODED_DIV:
+        POPPED_OPERATION_(
+            EmitRex(emitter, 0, 0);             // cqo
+            EmitByte(emitter, 0x99);
+            EmitRex(emitter, 0, HOST_RCX);      // idiv rcx
+            EmitByte(emitter, 0xf7);
+            EmitModRm(emitter, 3, 7, HOST_RCX);
+        );
+
+    case DECODED_SQRT:
+        FUNCTION_CALL_(JitSqrt);
+
+    case DECODED_SIN:
+        FUNCTION_CALL_(JitSin);
+
+    case DECODED_COS:
+        FUNCTION_CALL_(JitCos);
+
+    case DECODED_IN:
+        EmitRex(emitter, 0, OPERAND_STACK_REGISTER);            // add rbp, 8
+        EmitByte(emitter, 0x83);
+        EmitModRm(emitter, 3, 0, OPERAND_STACK_REGISTER);
+        EmitByte(emitter, 8);
+        EmitMovRegReg(emitter, HOST_RSI, OPERAND_STACK_REGISTER);
+        EmitMovRegImm(emitter, HOST_RDI, (uint64_t) io);
+        EmitCall(emitter, FunctionGetAddress(IoChannelRead));
+        EmitByte(emitter, 0x84);                                // test al, al
+        EmitByte(emitter, 0xc0);
+        EmitJump(emitter, JCC_E, failTarget);
+        return true;
+
+    case DECODED_OUT:
+        EmitOperandPop(emitter, HOST_RSI);
+        EmitMovRegImm(emitter, HOST_RDI, (uint64_t) io);
+        EmitCall(emitter, FunctionGetAddress(IoChannelWrite));
+        EmitByte(emitter, 0x84);                                // test al, al
+        EmitByte(emitter, 0xc0);
+        EmitJump(emitter, JCC_E, failTarget);
+        return true;
+
+    case DECODED_FLUSH:
+        EmitMovRegImm(emitter, HOST_RDI, (uint64_t) io);
+        EmitCall(emitter, FunctionGetAddress(IoChannelFlush));
+        EmitByte(emitter, 0x84);                                // test al, al
+        EmitByte(emitter, 0xc0);
+        EmitJump(emitter, JCC_E, failTarget);
+        return true;
+
+    case DECODED_DRAW:
+        EmitMovRegImm(emitter, HOST_RDI, (uint64_t) ram);
+        EmitMovRegImm(emitter, HOST_RSI, (uint64_t) renderer);
+        EmitCall(emitter, FunctionGetAddress(RamScreenDraw));
+        EmitByte(emitter, 0x84);                                // test al, al
+        EmitByte(emitter, 0xc0);
+        EmitJump(emitter, JCC_E, failTarget);
+        return true;
+
+    case DECODED_JMP:
+        EmitJump(emitter, JCC_ALWAYS, instruction->jumpTarget);
+        return true;
+
+    case DECODED_JA:
+        JUMP_IF_(JCC_G);
+
+    case DECODED_JAE:
+        JUMP_IF_(JCC_GE);
+
+    case DECODED_JB:
+        JUMP_IF_(JCC_L);
+
+    case DECODED_JBE:
+        JUMP_IF_(JCC_LE);
+
+    case DECODED_JE:
+        JUMP_IF_(JCC_E);
+
+    case DECODED_JNE:
+        JUMP_IF_(JCC_NE);
+
+    case DECODED_CALL:
+    {
+        EmitMovRegImm(emitter, HOST_RAX, (uint64_t) &jitCode->callStackTop);
+        EmitLoad(emitter, HOST_RCX, HOST_RAX, 0);
+        EmitMovRegImm(emitter, HOST_RDX, (uint64_t) (jitCode->callStack + JIT_CALL_STACK_CAPACITY));
+        EmitAluRegReg(emitter, ALU_CMP, HOST_RCX, HOST_RDX);
+        EmitJump(emitter, JCC_AE, failTarget);
+
+        EmitRex(emitter, HOST_RDX, 0);                          // lea rdx, [rip + returnOffset]
+        EmitByte(emitter, 0x8d);
+        EmitModRm(emitter, 0, HOST_RDX, 5);
+        const size_t leaRel32Offset = emitter->size;
+        EmitUint32(emitter, 0);
+
+        EmitStore(emitter, HOST_RCX, 0, HOST_RDX);
+        EmitRex(emitter, 0, HOST_RCX);                          // add rcx, 8
+        EmitByte(emitter, 0x83);
+        EmitModRm(emitter, 3, 0, HOST_RCX);
+        EmitByte(emitter, 8);
+        EmitStore(emitter, HOST_RAX, 0, HOST_RCX);
+        EmitJump(emitter, JCC_ALWAYS, instruction->jumpTarget);
+
+        int32_t returnRel32 = (int32_t) (emitter->size - (leaRel32Offset + sizeof(int32_t)));
+        memcpy(emitter->code + leaRel32Offset, &returnRel32, sizeof(returnRel32));
+        return true;
+    }
+
+    case DECODED_RET:
+        // Empty call stack makes RET jump to the beginning, as in interpreter.
+        EmitMovRegImm(emitter, HOST_RAX, (uint64_t) &jitCode->callStackTop);
+        EmitLoad(emitter, HOST_RCX, HOST_RAX, 0);
+        EmitMovRegImm(emitter, HOST_RDX, (uint64_t) jitCode->callStack);
+        EmitAluRegReg(emitter, ALU_CMP, HOST_RCX, HOST_RDX);
+        EmitJump(emitter, JCC_E, 0);
+
+        EmitRex(emitter, 0, HOST_RCX);                          // sub rcx, 8
+        EmitByte(emitter, 0x83);
+        EmitModRm(emitter, 3, 5, HOST_RCX);
+        EmitByte(emitter, 8);
+        EmitStore(emitter, HOST_RAX, 0, HOST_RCX);
+        EmitLoad(emitter, HOST_RAX, HOST_RCX, 0);
+        EmitByte(emitter, 0xff);                                // jmp rax
+        EmitModRm(emitter, 3, 4, HOST_RAX);
+        return true;
+
+    default:
+        LOG_PRINT(INFO, "JIT: can't compile %s.\n", 
+                  DecodedCmdGetName((decodedCmdName_t) instruction->cmdName));
+        return false;
+    }
+}
+#undef POPPED_OPERATION_
+#undef FUNCTION_CALL_
+#undef JUMP_IF_
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static int64_t JitSqrt(int64_t arg)
+{
+    return (int64_t) round(sqrt((double) arg));
+}
+
+
+static int64_t JitSin(int64_t arg)
+{
+    return (int64_t) round(sin((double) arg));
+}
+
+
+static int64_t JitCos(int64_t arg)
+{
+    return (int64_t) round(cos((double) arg));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static void EmitByte(JitEmitter* emitter, uint8_t byte)
+{
+    emitter->code[emitter->size++] = byte;
+}
+
+
+static void EmitUint32(JitEmitter* emitter, uint32_t value)
+{
+    memcpy(emitter->code + emitter->size, &value, sizeof(value));
+    emitter->size += sizeof(value);
+}
+
+
+static void EmitUint64(JitEmitter* emitter, uint64_t value)
+{
+    memcpy(emitter->code + emitter->size, &value, sizeof(value));
+    emitter->size += sizeof(value);
+}
+
+
+/**
+ * REX.W prefix with extension bits of ModRM reg and rm fields.
+ */
+static void EmitRex(JitEmitter* emitter, int reg, int rm)
+{
+    EmitByte(emitter, (uint8_t) (0x48 | ((reg >> 3) << 2) | (rm >> 3)));
+}
+
+
+static void EmitModRm(JitEmitter* emitter, int mod, int reg, int rm)
+{
+    EmitByte(emitter, (uint8_t) ((mod << 6) | ((reg & 7) << 3) | (rm & 7)));
+}
+
+
+static void EmitMovRegImm(JitEmitter* emitter, int reg, uint64_t immediate)
+{
+    EmitRex(emitter, 0, reg);
+    EmitByte(emitter, (uint8_t) (0xb8 + (reg & 7)));
+    EmitUint64(emitter, immediate);
+}
+
+
+static void EmitMovRegReg(JitEmitter* emitter, int destination, int source)
+{
+    EmitAluRegReg(emitter, 0x89, destination, source);
+}
+
+
+static void EmitAluRegReg(JitEmitter* emitter, uint8_t opcode, int destination, int source)
+{
+    EmitRex(emitter, source, destination);
+    EmitByte(emitter, opcode);
+    EmitModRm(emitter, 3, source, destination);
+}
+
+
+static void EmitImulRegReg(JitEmitter* emitter, int destination, int source)
+{
+    EmitRex(emitter, destination, source);
+    EmitByte(emitter, 0x0f);
+    EmitByte(emitter, 0xaf);
+    EmitModRm(emitter, 3, destination, source);
+}
+
+
+/**
+ * Base mustn't be rsp or r12, they need SIB byte.
+ */
+static void EmitLoad(JitEmitter* emitter, int destination, int base, int8_t displacement)
+{
+    EmitRex(emitter, destination, base);
+    EmitByte(emitter, 0x8b);
+    EmitModRm(emitter, 1, destination, base);
+    EmitByte(emitter, (uint8_t) displacement);
+}
+
+
+static void EmitStore(JitEmitter* emitter, int base, int8_t displacement, int source)
+{
+    EmitRex(emitter, source, base);
+    EmitByte(emitter, 0x89);
+    EmitModRm(emitter, 1, source, base);
+    EmitByte(emitter, (uint8_t) displacement);
+}
+
+
+static void EmitPushHost(JitEmitter* emitter, int reg)
+{
+    if (reg >= 8)
+        EmitByte(emitter, 0x41);
+    EmitByte(emitter, (uint8_t) (0x50 + (reg & 7)));
+}
+
+
+static void EmitPopHost(JitEmitter* emitter, int reg)
+{
+    if (reg >= 8)
+        EmitByte(emitter, 0x41);
+    EmitByte(emitter, (uint8_t) (0x58 + (reg & 7)));
+}
+
+
+static void EmitCall(JitEmitter* emitter, uint64_t functionAddress)
+{
+    EmitMovRegImm(emitter, HOST_RAX, functionAddress);
+    EmitByte(emitter, 0xff);                    // call rax
+    EmitModRm(emitter, 3, 2, HOST_RAX);
+}
+
+
+static void EmitJump(JitEmitter* emitter, uint8_t conditionCode, uint32_t target)
+{
+    if (conditionCode == JCC_ALWAYS)
+    {
+        EmitByte(emitter, 0xe9);
+    }
+    else
+    {
+        EmitByte(emitter, 0x0f);
+        EmitByte(emitter, conditionCode);
+    }
+
+    emitter->fixups[emitter->fixupCount++] = {.rel32Offset = emitter->size, .target = target};
+    EmitUint32(emitter, 0);
+}
+
+
+static void EmitOperandPush(JitEmitter* emitter, int reg)
+{
+    EmitRex(emitter, 0, OPERAND_STACK_REGISTER);        // add rbp, 8
+    EmitByte(emitter, 0x83);
+    EmitModRm(emitter, 3, 0, OPERAND_STACK_REGISTER);
+    EmitByte(emitter, 8);
+    EmitStore(emitter, OPERAND_STACK_REGISTER, 0, reg);
+}
+
+
+static void EmitOperandPop(JitEmitter* emitter, int reg)
+{
+    EmitLoad(emitter, reg, OPERAND_STACK_REGISTER, 0);
+    EmitRex(emitter, 0, OPERAND_STACK_REGISTER);        // sub rbp, 8
+    EmitByte(emitter, 0x83);
+    EmitModRm(emitter, 3, 5, OPERAND_STACK_REGISTER);
+    EmitByte(emitter, 8);
+}
+
+
+/**
+ * Compute argument of PUSH/POP in rax. It spoils rdx.
+ */
+static void EmitAddressCompute(JitEmitter* emitter, DecodedInstruction* instruction,
+                               bool isRegister, bool isConst)
+{
+    const int firstRegister = PINNED_REGISTERS[instruction->registerNum % PINNED_REGISTER_COUNT];
+
+    if (isRegister && isConst)
+    {
+        EmitMovRegReg(emitter, HOST_RAX, firstRegister);
+        EmitMovRegImm(emitter, HOST_RDX, (uint64_t) instruction->immediate);
+        EmitAluRegReg(emitter, ALU_ADD, HOST_RAX, HOST_RDX);
+    }
+    else if (isRegister)
+    {
+        EmitMovRegReg(emitter, HOST_RAX, firstRegister);
+    }
+    else
+    {
+        EmitMovRegImm(emitter, HOST_RAX, (uint64_t) instruction->immediate);
+    }
+}
+
+
+/**
+ * rcx = RAM[rax] or 0 if rax is out of RAM, as RamGetValue() does.
+ */
+static void EmitRamLoad(JitEmitter* emitter, size_t ramSize)
+{
+    EmitByte(emitter, 0x31);                    // xor ecx, ecx
+    EmitModRm(emitter, 3, HOST_RCX, HOST_RCX);
+    EmitMovRegImm(emitter, HOST_RDX, ramSize);
+    EmitAluRegReg(emitter, ALU_CMP, HOST_RAX, HOST_RDX);
+    EmitByte(emitter, 0x73);                    // jae over load
+    EmitByte(emitter, 4);
+
+    EmitRex(emitter, HOST_RCX, 0);              // mov rcx, [rbx + rax * 8]
+    EmitByte(emitter, 0x8b);
+    EmitModRm(emitter, 0, HOST_RCX, 4);
+    EmitModRm(emitter, 3, HOST_RAX, RAM_BASE_REGISTER);
+}
+
+
+/**
+ * RAM[rax] = rcx if rax is in RAM, as RamCellSet() does.
+ */
+static void EmitRamStore(JitEmitter* emitter, size_t ramSize)
+{
+    EmitMovRegImm(emitter, HOST_RDX, ramSize);
+    EmitAluRegReg(emitter, ALU_CMP, HOST_RAX, HOST_RDX);
+    EmitByte(emitter, 0x73);                    // jae over store
+    EmitByte(emitter, 4);
+
+    EmitRex(emitter, HOST_RCX, 0);              // mov [rbx + rax * 8], rcx
+    EmitByte(emitter, 0x89);
+    EmitModRm(emitter, 0, HOST_RCX, 4);
+    EmitModRm(emitter, 3, HOST_RAX, RAM_BASE_REGISTER);
+}
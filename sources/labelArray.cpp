@@ -3,27 +3,41 @@
 #include <string.h>
 
 #include "labelArray.h"
+#include "fnvHash.h"
 
 
 //--------------------------------------------------------------------------------------------------
 
 
+static const size_t NAMES_MIN_CAPACITY = 1024;
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+#ifdef _DEBUG
 static bool LabelArrayVerify(LabelArray* labelArray);
 
 
-static bool LabelVerify(Label* label);
+static bool LabelVerify(LabelArray* labelArray, Label* label);
+#endif
+
 
+static void LabelArraySetPoison(Label* data, size_t capacity);
 
-static bool LabelNameVerify(Label* label);
 
+static bool LabelArrayResize(LabelArray* labelArray, size_t newCapacity);
 
-static void LabelArraySetPoison(LabelArray* labelArray);
 
+static bool LabelNameIntern(LabelArray* labelArray, const char* labelName, size_t nameLength,
+                            size_t* nameOffsetBuffer);
 
-static void LabelDump(Label* label);
 
+static void LabelDump(LabelArray* labelArray, Label* label);
 
-static bool LabelFindNum(LabelArray* labelArray, char* labelName, size_t* labelNumBuffer);
+
+static Label* LabelFindSlot(LabelArray* labelArray, const char* labelName, size_t nameLength,
+                            uint64_t hash);
 
 
 //--------------------------------------------------------------------------------------------------
@@ -31,9 +45,9 @@ static bool LabelFindNum(LabelArray* labelArray, char* labelName, size_t* labelN
 
 bool LabelArrayCreate(LabelArray* labelArray, Place place)
 {
-    labelArray->labelCount = 0;
+    *labelArray = {};
 
-    labelArray->data = (Label*) calloc(MAX_LABEL_COUNT, sizeof(Label));
+    labelArray->data = (Label*) calloc(LABEL_ARRAY_MIN_CAPACITY, sizeof(Label));
     if (labelArray->data == NULL)
     {
         LOG_PRINT(ERROR, "%s: %s(): line %d: labelData == NULL\n",
@@ -41,7 +55,8 @@ bool LabelArrayCreate(LabelArray* labelArray, Place place)
         return false;
     }
 
-    LabelArraySetPoison(labelArray);
+    labelArray->capacity = LABEL_ARRAY_MIN_CAPACITY;
+    LabelArraySetPoison(labelArray->data, labelArray->capacity);
 
     return true;
 }
@@ -50,31 +65,38 @@ bool LabelArrayCreate(LabelArray* labelArray, Place place)
 void LabelArrayDelete(LabelArray* labelArray)
 {
     free(labelArray->data);
-    
-    labelArray->data  = NULL;
-    labelArray->labelCount = 0;
+    free(labelArray->names);
+
+    *labelArray = {};
 }
 
 
 void LabelArrayDump(LabelArray* labelArray, Place place)
 {
-    LOG_PRINT(INFO, "%s: %s(): line %d: LabelArray dumping...\n", 
+    LOG_PRINT(INFO, "%s: %s(): line %d: LabelArray dumping...\n",
               place.file, place.function, place.line);
     LOG_DUMMY_PRINT("\tlabelCount = %zu\n"
-                    "\tlabelData  = %p\n", 
+                    "\tcapacity   = %zu\n"
+                    "\tlabelData  = %p\n"
+                    "\tnamesSize  = %zu\n",
                     labelArray->labelCount,
-                    labelArray->data);
+                    labelArray->capacity,
+                    labelArray->data,
+                    labelArray->namesSize);
 
     if (labelArray->data != NULL)
     {
         LOG_DUMMY_PRINT("Labels:\n");
-        char* format = GetArrayPrintingFormat(place, labelArray->labelCount);
+        char* format = GetArrayPrintingFormat(place, labelArray->capacity);
 
-        for (size_t labelNum = 0; labelNum < labelArray->labelCount; labelNum++)
+        for (size_t labelNum = 0; labelNum < labelArray->capacity; labelNum++)
         {
+            if (labelArray->data[labelNum].instructionNum == LABEL_POISON_NUM)
+                continue;
+
             LOG_DUMMY_PRINT(format, labelNum);
             LOG_DUMMY_PRINT("\n");
-            LabelDump(labelArray->data + labelNum);
+            LabelDump(labelArray, labelArray->data + labelNum);
             LOG_DUMMY_PRINT("\n");
         }
 
@@ -83,109 +105,86 @@ void LabelArrayDump(LabelArray* labelArray, Place place)
 }
 
 
-bool LabelAdd(LabelArray* labelArray, char* labelName, const size_t instructionNum)
+bool LabelAdd(LabelArray* labelArray, const char* labelName, size_t nameLength, 
+              const size_t instructionNum)
 {
     if (labelName == NULL)
     {
         LOG_PRINT(ERROR, "labelName == NULL\n");
         return false;
     }
-    
+
     if (instructionNum == LABEL_POISON_NUM)
     {
         LOG_PRINT(ERROR, "instructionNum == POISON == %zu\n", LABEL_POISON_NUM);
         return false;
     }
 
-    Label* label = labelArray->data + labelArray->labelCount;
-    label->instructionNum = instructionNum;
+    if (2 * (labelArray->labelCount + 1) > labelArray->capacity &&
+        !LabelArrayResize(labelArray, 2 * labelArray->capacity))
+        return false;
+
+    const uint64_t hash = LabelNameGetHash(labelName, nameLength);
 
-    for (size_t charNum = 0; charNum < MAX_LABEL_NAME_LENGTH; charNum++)
+    Label* label = LabelFindSlot(labelArray, labelName, nameLength, hash);
+    if (label->instructionNum != LABEL_POISON_NUM)
     {
-        if (labelName[charNum] == '\0')
-            break;
-        
-        label->name[charNum] = labelName[charNum];
+        LOG_PRINT(ERROR, "label <%.*s> exists\n", (int) nameLength, labelName);
+        return false;
     }
 
+    size_t nameOffset = 0;
+    if (!LabelNameIntern(labelArray, labelName, nameLength, &nameOffset))
+        return false;
+
+    *label = {
+        .nameOffset     = nameOffset,
+        .nameLength     = nameLength,
+        .hash           = hash,
+        .instructionNum = instructionNum,
+    };
     (labelArray->labelCount)++;
     return true;
 }
 
 
-bool LabelFind(LabelArray* labelArray, char* labelName, size_t* instructionNumBuffer)
+bool LabelFind(LabelArray* labelArray, const char* labelName, size_t nameLength, 
+               size_t* instructionNumBuffer)
 {
+#ifdef _DEBUG
     if (!LabelArrayVerify(labelArray))
     {
         LABEL_ARRAY_DUMP(labelArray);
         return false;
     }
+#endif
 
-    for (size_t labelNum = 0; labelNum < labelArray->labelCount; labelNum++)
-    {
-        Label* label = labelArray->data + labelNum;
-        if (strcmp(label->name, labelName) == 0)
-        {
-            *instructionNumBuffer = label->instructionNum;
-            return true;
-        }
-    }
-
-    return false;
-}
-
+    Label* label = LabelFindSlot(labelArray, labelName, nameLength,
+                                 LabelNameGetHash(labelName, nameLength));
+    if (label->instructionNum == LABEL_POISON_NUM)
+        return false;
 
-bool LabelIs(char* labelName) 
-{
-    if (strlen(labelName) > 1 && labelName[strlen(labelName) - 1] == ':')
-        return true;
-    
-    return false;
+    *instructionNumBuffer = label->instructionNum;
+    return true;
 }
 
 
-bool LabelChangeInstructionNum(LabelArray* labelArray, char* labelName, 
-                               const size_t newInstructionNum)
+uint64_t LabelNameGetHash(const char* labelName, size_t nameLength)
 {
-    if (!LabelArrayVerify(labelArray))
-    {
-        LABEL_ARRAY_DUMP(labelArray);
-        return false;
-    }
-
-    size_t prevInstructionNum = LABEL_POISON_NUM;
-    LabelFind(labelArray, labelName, &prevInstructionNum);
-    if (prevInstructionNum == LABEL_POISON_NUM)
-        return false;
-
-    size_t labelNum = LABEL_POISON_NUM;
-    if(!LabelFindNum(labelArray, labelName, &labelNum))
-        return false;
-
-    Label* label = labelArray->data + labelNum;
-    label->instructionNum = newInstructionNum;
-    return true;
+    return FnvHashGet(labelName, nameLength);
 }
 
 
-bool LabelAddOrChangeInstructionNum(LabelArray* labelArray, char* labelName,
-                                    const size_t newInstructionNum)
+bool LabelIs(const char* word, size_t wordLength)
 {
-    size_t prevInstructionNum = LABEL_POISON_NUM;
-    LabelFind(labelArray, labelName, &prevInstructionNum);
-    
-    if (prevInstructionNum != LABEL_POISON_NUM)
-    {
-        return LabelChangeInstructionNum(labelArray, labelName, newInstructionNum);
-    }
-    
-    return LabelAdd(labelArray, labelName, newInstructionNum);
+    return wordLength > 1 && word[wordLength - 1] == ':';
 }
 
 
 //--------------------------------------------------------------------------------------------------
 
 
+#ifdef _DEBUG
 static bool LabelArrayVerify(LabelArray* labelArray)
 {
     if (labelArray == NULL)
@@ -194,119 +193,165 @@ static bool LabelArrayVerify(LabelArray* labelArray)
         return false;
     }
 
-    if (labelArray->labelCount > MAX_LABEL_COUNT)
+    if (2 * labelArray->labelCount > labelArray->capacity ||
+        (labelArray->capacity & (labelArray->capacity - 1)) != 0)
     {
-        LOG_PRINT(ERROR, "labelCount = %zu is bigger than maxLabelCount = %zu\n",
-                  labelArray->labelCount, MAX_LABEL_COUNT);        
+        LOG_PRINT(ERROR, "labelCount = %zu doesn't fit capacity = %zu\n",
+                  labelArray->labelCount, labelArray->capacity);
         return false;
-    }    
+    }
 
-    for (size_t labelNum = 0; labelNum < labelArray->labelCount; labelNum++)
-        if (!LabelVerify(labelArray->data + labelNum))
+    size_t labelCount = 0;
+    for (size_t labelNum = 0; labelNum < labelArray->capacity; labelNum++)
+    {
+        Label* label = labelArray->data + labelNum;
+        if (label->instructionNum == LABEL_POISON_NUM)
+            continue;
+
+        labelCount++;
+        if (!LabelVerify(labelArray, label))
         {
             LOG_PRINT(ERROR, "labelNum = %zu isn't verified\n", labelNum);
             return false;
         }
+    }
+
+    if (labelCount != labelArray->labelCount)
+    {
+        LOG_PRINT(ERROR, "labelCount = %zu, but there are %zu labels\n",
+                  labelArray->labelCount, labelCount);
+        return false;
+    }
 
     return true;
 }
 
 
-static bool LabelVerify(Label* label)
+static bool LabelVerify(LabelArray* labelArray, Label* label)
 {
-    if (label == NULL)
+    if (label->nameLength == 0 || label->nameOffset > labelArray->namesSize ||
+        label->nameLength >= labelArray->namesSize - label->nameOffset)
     {
-        LOG_PRINT(ERROR, "label == NULL");
+        LOG_PRINT(ERROR, "name is out of names, offset = %zu, length = %zu\n",
+                  label->nameOffset, label->nameLength);
         return false;
     }
 
-    if (label->instructionNum == LABEL_POISON_NUM)
+    const char* labelName = labelArray->names + label->nameOffset;
+    if (labelName[label->nameLength] != '\0' ||
+        LabelNameGetHash(labelName, label->nameLength) != label->hash)
     {
-        LOG_PRINT(ERROR, "instructionNum is poisoned, instructionNum == %zu\n", 
-                  LABEL_POISON_NUM);
+        LOG_PRINT(ERROR, "labelName isn't verified!\n");
+        LabelDump(labelArray, label);
         return false;
     }
 
-    if (!LabelNameVerify(label))
-    {
-        LOG_PRINT(ERROR, "labelName isn't verified!");
-        LOG_DUMMY_PRINT("labelName = ");
-        for (size_t charNum = 0; charNum <= MAX_LABEL_NAME_LENGTH; charNum++)
-        {
-            char nextChar = label->name[charNum];
-            LOG_DUMMY_PRINT("<%c = %d> ", nextChar, nextChar);
-        }
+    return true;
+}
+#endif
 
-        return false;
-    }
 
-    return true;
+static void LabelArraySetPoison(Label* data, size_t capacity)
+{
+    for (size_t labelNum = 0; labelNum < capacity; labelNum++)
+        data[labelNum].instructionNum = LABEL_POISON_NUM;
 }
 
 
-static void LabelArraySetPoison(LabelArray* labelArray)
+/**
+ * Move labels to new table, names stay in place.
+ */
+static bool LabelArrayResize(LabelArray* labelArray, size_t newCapacity)
 {
-    for (size_t labelNum = 0; labelNum < MAX_LABEL_COUNT; labelNum++)
+    Label* newData = (Label*) calloc(newCapacity, sizeof(Label));
+    if (newData == NULL)
+    {
+        LOG_PRINT(ERROR, "Can't allocate %zu labels.\n", newCapacity);
+        return false;
+    }
+    LabelArraySetPoison(newData, newCapacity);
+
+    for (size_t labelNum = 0; labelNum < labelArray->capacity; labelNum++)
     {
         Label* label = labelArray->data + labelNum;
-        label->instructionNum = LABEL_POISON_NUM;
+        if (label->instructionNum == LABEL_POISON_NUM)
+            continue;
+
+        size_t slotNum = label->hash & (newCapacity - 1);
+        while (newData[slotNum].instructionNum != LABEL_POISON_NUM)
+            slotNum = (slotNum + 1) & (newCapacity - 1);
+
+        newData[slotNum] = *label;
     }
+
+    free(labelArray->data);
+    labelArray->data     = newData;
+    labelArray->capacity = newCapacity;
+    return true;
 }
 
 
-static void LabelDump(Label* label)
+static bool LabelNameIntern(LabelArray* labelArray, const char* labelName, size_t nameLength,
+                            size_t* nameOffsetBuffer)
 {
-    if (label->name == NULL)
-        LOG_DUMMY_PRINT("name == NULL\n");
-    else
+    const size_t newSize = labelArray->namesSize + nameLength + 1;
+    if (newSize > labelArray->namesCapacity)
     {
-        for (size_t charNum = 0; charNum < MAX_LABEL_NAME_LENGTH; charNum++)
-        {
-            if (label->name[charNum] == '\0')
-                break;
-            LOG_DUMMY_PRINT("%c", label->name[charNum]);
-        }
-        
-        for (size_t charNum = 0; charNum < MAX_LABEL_NAME_LENGTH; charNum++)
+        size_t newCapacity = (labelArray->namesCapacity == 0) ?
+                                 NAMES_MIN_CAPACITY : labelArray->namesCapacity;
+        while (newCapacity < newSize)
+            newCapacity *= 2;
+
+        char* newNames = (char*) realloc(labelArray->names, newCapacity);
+        if (newNames == NULL)
         {
-            if (label->name[charNum] == '\0')
-                break;
-            LOG_DUMMY_PRINT("%d ", label->name[charNum]);
+            LOG_PRINT(ERROR, "Can't allocate %zu bytes of label names.\n", newCapacity);
+            return false;
         }
 
-        LOG_DUMMY_PRINT("\n");
+        labelArray->names         = newNames;
+        labelArray->namesCapacity = newCapacity;
     }
 
-    if (label->instructionNum == LABEL_POISON_NUM)
-        LOG_DUMMY_PRINT("***");
-
-    LOG_DUMMY_PRINT("instructionNum = %zu\n", label->instructionNum);
+    memcpy(labelArray->names + labelArray->namesSize, labelName, nameLength);
+    labelArray->names[labelArray->namesSize + nameLength] = '\0';
+    *nameOffsetBuffer     = labelArray->namesSize;
+    labelArray->namesSize = newSize;
+    return true;
 }
 
 
-static bool LabelNameVerify(Label* label)
+static void LabelDump(LabelArray* labelArray, Label* label)
 {
-    if (label->name[MAX_LABEL_NAME_LENGTH] != '\0')
-        return false;
+    if (label->nameOffset + label->nameLength < labelArray->namesSize)
+        LOG_DUMMY_PRINT("%.*s\n", (int) label->nameLength, labelArray->names + label->nameOffset);
+    else
+        LOG_DUMMY_PRINT("name is out of names\n");
 
-    if (label->name[0] == '\0')
-        return false;
+    LOG_DUMMY_PRINT("hash = %016lx\n", label->hash);
 
-    return true;
+    if (label->instructionNum == LABEL_POISON_NUM)
+        LOG_DUMMY_PRINT("***");
+
+    LOG_DUMMY_PRINT("instructionNum = %zu\n", label->instructionNum);
 }
 
 
-static bool LabelFindNum(LabelArray* labelArray, char* labelName, size_t* labelNumBuffer)
+/**
+ * @return slot of label or empty slot where it must be added.
+ */
+static Label* LabelFindSlot(LabelArray* labelArray, const char* labelName, size_t nameLength,
+                            uint64_t hash)
 {
-    for (size_t labelNum = 0; labelNum < labelArray->labelCount; labelNum++)
+    const size_t mask = labelArray->capacity - 1;
+    for (size_t slotNum = hash & mask; ; slotNum = (slotNum + 1) & mask)
     {
-        Label* label = labelArray->data + labelNum;
-        if (strcmp(label->name, labelName) == 0)
-        {
-            *labelNumBuffer = labelNum;
-            return true;
-        }
-    }
+        Label* label = labelArray->data + slotNum;
+        if (label->instructionNum == LABEL_POISON_NUM)
+            return label;
 
-    return false;
+        if (label->hash == hash && label->nameLength == nameLength &&
+            memcmp(labelArray->names + label->nameOffset, labelName, nameLength) == 0)
+            return label;
+    }
 }
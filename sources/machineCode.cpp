@@ -1,15 +1,57 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "fileProcessor.h"
 #include "machineCode.h"
+#include "bytecode.h"
+#include "fnvHash.h"
 #include "logPrinter.h"
 
 
 //--------------------------------------------------------------------------------------------------
 
 
-static const size_t maxInstructionsCount = 1024;
+static const size_t CODE_MIN_CAPACITY = 1024;
+
+static const size_t LINES_MIN_CAPACITY = 64;
+
+
+/**
+ * Sections of file which is written, code is the last one.
+ */
+enum WRITTEN_SECTIONS
+{
+    WRITTEN_SECTION_LAYOUT,
+    WRITTEN_SECTION_LINES,
+    WRITTEN_SECTION_CODE,
+    WRITTEN_SECTION_COUNT
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool MachineCodeGrow(MachineCode* machineCode);
+
+
+static bool MachineCodeReadOld(MachineCode* machineCode, char* fileName);
+
+
+static bool MachineCodeReadSections(MachineCode* machineCode);
+
+
+static bool MachineCodeReadBytecode(MachineCode* machineCode, const char* section, size_t size);
+
+
+static uint8_t* MachineCodeGetBytecodeSection(MachineCode* machineCode, size_t* sizeBuffer);
+
+
+static uint64_t SectionGetChecksum(const void* section, size_t size);
 
 
 //--------------------------------------------------------------------------------------------------
@@ -17,50 +59,76 @@ static const size_t maxInstructionsCount = 1024;
 
 bool MachineCodeInit(MachineCode* machineCode)
 {
-    machineCode->instructionCount = maxInstructionsCount;
-    machineCode->instructionNum   = FIRST_INSTRUCTION_NUM;
+    *machineCode = {};
+    machineCode->instructionNum = FIRST_INSTRUCTION_NUM;
 
-    machineCode->code = (instruction_t*) calloc(maxInstructionsCount + 1, sizeof(instruction_t));
-    if (machineCode == NULL)
+    machineCode->code = (instruction_t*) calloc(CODE_MIN_CAPACITY, sizeof(instruction_t));
+    if (machineCode->code == NULL)
         return false;
 
+    machineCode->codeCapacity = CODE_MIN_CAPACITY;
     return true;
 }
 
 
 bool MachineCodeInitFromFile(MachineCode* machineCode, char* fileName)
 {
+    *machineCode = {};
     if (!FileNameCheckExtension(fileName, MACHINE_CODE_FILE_EXTENSION))
         return false;
 
-    FILE* machineCodeFile = fopen(fileName, "rb");
-    if (machineCodeFile == NULL)
+    int fd = open(fileName, O_RDONLY);
+    if (fd == -1)
         return false;
 
-    fread(&(machineCode->instructionCount), sizeof(instruction_t), 1, machineCodeFile);
-    machineCode->code = (instruction_t*) calloc(machineCode->instructionCount, 
-                                                sizeof(instruction_t));
-    if (machineCode->code == NULL)
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0)
     {
-        fclose(machineCodeFile);
+        close(fd);
         return false;
     }
 
-    fread(machineCode->code, sizeof(instruction_t), machineCode->instructionCount, machineCodeFile);
-    machineCode->instructionNum = 0;
+    char signature[sizeof(MACHINE_CODE_FILE_SIGNATURE)] = {};
+    if (read(fd, signature, sizeof(signature)) != (ssize_t) sizeof(signature) ||
+        memcmp(signature, MACHINE_CODE_FILE_SIGNATURE, sizeof(signature)) != 0)
+    {
+        close(fd);
+        return MachineCodeReadOld(machineCode, fileName);
+    }
+
+    void* mapped = mmap(NULL, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        return false;
+
+    machineCode->mapped     = mapped;
+    machineCode->mappedSize = (size_t) fileStat.st_size;
+    if (!MachineCodeReadSections(machineCode))
+    {
+        ColoredPrintf(RED, "%s is damaged.\n", fileName);
+        MachineCodeDelete(machineCode);
+        return false;
+    }
 
-    fclose(machineCodeFile);
     return true;
 }
 
 
 void MachineCodeDelete(MachineCode* machineCode)
 {
-    free(machineCode->code);
-    machineCode->code = NULL;
+    if (machineCode->mapped != NULL)
+    {
+        munmap(machineCode->mapped, machineCode->mappedSize);
+        if (machineCode->isCodeAllocated)
+            free(machineCode->code);
+    }
+    else
+    {
+        free(machineCode->code);
+        free(machineCode->lines);
+    }
 
-    machineCode->instructionCount = 0;
-    machineCode->instructionNum   = 0;
+    *machineCode = {};
 }
 
 
@@ -78,11 +146,18 @@ codeStatus_t MachineCodeGetNextInstruction(MachineCode* machineCode,
 
 codeStatus_t MachineCodeAddInstruction(MachineCode* machineCode, const instruction_t instruction)
 {
-    if (machineCode->instructionNum >= machineCode->instructionCount)
+    if (machineCode->instructionNum >= machineCode->codeCapacity &&
+        !MachineCodeGrow(machineCode))
+    {
+        machineCode->isOverflowed = true;
         return CODE_OVERFLOW;
+    }
     
     machineCode->code[machineCode->instructionNum] = instruction;
     (machineCode->instructionNum)++;
+    if (machineCode->instructionNum > machineCode->instructionCount)
+        machineCode->instructionCount = machineCode->instructionNum;
+
     return CODE_OK;
 }
 
@@ -114,23 +189,132 @@ codeStatus_t MachineCodeJump(MachineCode* machineCode, const jumpMode_t jumpMode
 }
 
 
-bool MachineCodeWriteToFile(MachineCode* machineCode, char* fileName)
+/**
+ * Small sections are written after section table, code is written at aligned offset.
+ * Bytecode is decoded at load, so it isn't aligned.
+ */
+bool MachineCodeWriteToFile(MachineCode* machineCode, char* fileName, bool isCompact)
 {
+    size_t   bytecodeSize = 0;
+    uint8_t* bytecode     = isCompact ? MachineCodeGetBytecodeSection(machineCode, &bytecodeSize) : 
+                                        NULL;
+    if (isCompact && bytecode == NULL)
+        ColoredPrintf(RED, "Can't encode bytecode, code of %s is written as instructions.\n",
+                      fileName);
+
     FILE* file = fopen(fileName, "wb");
     if (file == NULL)
     {
         ColoredPrintf(RED, "Can't write machine code to %s.\n", fileName);
+        free(bytecode);
         return false;
     }
 
-    fwrite(&(machineCode->instructionNum), sizeof(size_t), 1, file);
-    fwrite(machineCode->code, sizeof(instruction_t), machineCode->instructionNum, file);
+    const MemoryLayout* layout         = &machineCode->layout;
+    const uint64_t      layoutWords[3] = {layout->ramSize, layout->screenWidth, 
+                                          layout->screenHeight};
+
+    const void* sectionData[WRITTEN_SECTION_COUNT] = {};
+    sectionData[WRITTEN_SECTION_LAYOUT] = layoutWords;
+    sectionData[WRITTEN_SECTION_LINES]  = machineCode->lines;
+    sectionData[WRITTEN_SECTION_CODE]   = machineCode->code;
+
+    MachineCodeSection sections[WRITTEN_SECTION_COUNT] = {};
+    sections[WRITTEN_SECTION_LAYOUT] = {.type = SECTION_LAYOUT, .size = sizeof(layoutWords)};
+    sections[WRITTEN_SECTION_LINES]  = {.type = SECTION_LINES,  
+                                        .size = machineCode->lineCount * sizeof(MachineCodeLine)};
+    sections[WRITTEN_SECTION_CODE]   = {.type = SECTION_CODE,
+                                        .size = machineCode->instructionNum * 
+                                                sizeof(instruction_t)};
+    if (bytecode != NULL)
+    {
+        sectionData[WRITTEN_SECTION_CODE] = bytecode;
+        sections[WRITTEN_SECTION_CODE]    = {.type = SECTION_BYTECODE, .size = bytecodeSize};
+    }
+
+    uint64_t offset = sizeof(MachineCodeFileHeader) + sizeof(sections);
+    for (size_t sectionNum = 0; sectionNum < WRITTEN_SECTION_COUNT; sectionNum++)
+    {
+        if (sections[sectionNum].type == SECTION_CODE)
+            offset = (offset + MACHINE_CODE_SECTION_ALIGNMENT - 1) / 
+                     MACHINE_CODE_SECTION_ALIGNMENT * MACHINE_CODE_SECTION_ALIGNMENT;
+
+        sections[sectionNum].offset   = offset;
+        sections[sectionNum].checksum = SectionGetChecksum(sectionData[sectionNum], 
+                                                           sections[sectionNum].size);
+        offset += sections[sectionNum].size;
+    }
+
+    MachineCodeFileHeader header = {
+        .signature    = {},
+        .version      = MACHINE_CODE_FILE_VERSION,
+        .flags        = 0,
+        .sectionCount = WRITTEN_SECTION_COUNT,
+    };
+    memcpy(header.signature, MACHINE_CODE_FILE_SIGNATURE, sizeof(MACHINE_CODE_FILE_SIGNATURE));
+
+    bool isWritten = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                     fwrite(sections, sizeof(sections), 1, file) == 1;
+
+    // Gap before code is a hole of file, it is read as zeros.
+    for (size_t sectionNum = 0; isWritten && sectionNum < WRITTEN_SECTION_COUNT; sectionNum++)
+        isWritten = sections[sectionNum].size == 0 ||
+                    (fseek(file, (long) sections[sectionNum].offset, SEEK_SET) == 0 &&
+                     fwrite(sectionData[sectionNum], sections[sectionNum].size, 1, file) == 1);
+
+    free(bytecode);
+    if (fclose(file) != 0 || !isWritten)
+    {
+        ColoredPrintf(RED, "Can't write machine code to %s.\n", fileName);
+        return false;
+    }
+
+    return true;
+}
+
+
+bool MachineCodeAddLine(MachineCode* machineCode, size_t lineNum)
+{
+    if (machineCode->lineCount == machineCode->lineCapacity)
+    {
+        const size_t newCapacity = (machineCode->lineCapacity == 0) ? 
+                                       LINES_MIN_CAPACITY : 2 * machineCode->lineCapacity;
+        MachineCodeLine* newLines = (MachineCodeLine*) realloc(machineCode->lines, 
+                                                               newCapacity * 
+                                                               sizeof(MachineCodeLine));
+        if (newLines == NULL)
+            return false;
+
+        machineCode->lines        = newLines;
+        machineCode->lineCapacity = newCapacity;
+    }
 
-    fclose(file);
+    machineCode->lines[machineCode->lineCount++] = {
+        .instructionNum = machineCode->instructionNum,
+        .lineNum        = lineNum,
+    };
     return true;
 }
 
 
+size_t MachineCodeGetLineNum(MachineCode* machineCode, size_t instructionNum)
+{
+    // The last line which starts not after instructionNum.
+    size_t left  = 0;
+    size_t right = machineCode->lineCount;
+    while (left < right)
+    {
+        const size_t middle = left + (right - left) / 2;
+        if (machineCode->lines[middle].instructionNum <= instructionNum)
+            left = middle + 1;
+        else
+            right = middle;
+    }
+
+    return (left == 0) ? 0 : machineCode->lines[left - 1].lineNum;
+}
+
+
 size_t MachineCodeGetInstructionNum(MachineCode* machineCode)
 {
     return machineCode->instructionNum;
@@ -141,3 +325,259 @@ void MachineCodeSkipInstruction(MachineCode* machineCode)
 {
     machineCode->instructionNum++;
 }
+
+
+bool MachineCodeResize(MachineCode* machineCode, size_t instructionCount, size_t lineCount)
+{
+    if (machineCode->mapped != NULL)
+        return false;
+
+    if (machineCode->codeCapacity < instructionCount)
+    {
+        instruction_t* newCode = (instruction_t*) realloc(machineCode->code, 
+                                                          instructionCount * sizeof(instruction_t));
+        if (newCode == NULL)
+        {
+            LOG_PRINT(ERROR, "Can't allocate %zu instructions.\n", instructionCount);
+            return false;
+        }
+
+        machineCode->code         = newCode;
+        machineCode->codeCapacity = instructionCount;
+    }
+
+    if (machineCode->lineCapacity < lineCount)
+    {
+        MachineCodeLine* newLines = (MachineCodeLine*) realloc(machineCode->lines, 
+                                                               lineCount * sizeof(MachineCodeLine));
+        if (newLines == NULL)
+            return false;
+
+        machineCode->lines        = newLines;
+        machineCode->lineCapacity = lineCount;
+    }
+
+    machineCode->instructionCount = instructionCount;
+    machineCode->instructionNum   = instructionCount;
+    machineCode->lineCount        = lineCount;
+    return true;
+}
+
+
+void MachineCodeWritePart(MachineCode* machineCode, const MachineCode* part, 
+                          size_t instructionShift, size_t lineTableShift, size_t lineShift)
+{
+    memcpy(machineCode->code + instructionShift, part->code, 
+           part->instructionCount * sizeof(instruction_t));
+
+    MachineCodeLine* lines = machineCode->lines + lineTableShift;
+    for (size_t lineNum = 0; lineNum < part->lineCount; lineNum++)
+    {
+        lines[lineNum] = {
+            .instructionNum = part->lines[lineNum].instructionNum + instructionShift,
+            .lineNum        = part->lines[lineNum].lineNum        + lineShift,
+        };
+    }
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Code of file can't grow, it is mapped.
+ */
+static bool MachineCodeGrow(MachineCode* machineCode)
+{
+    if (machineCode->mapped != NULL || machineCode->codeCapacity == 0)
+        return false;
+
+    const size_t   newCapacity = 2 * machineCode->codeCapacity;
+    instruction_t* newCode     = (instruction_t*) realloc(machineCode->code, 
+                                                          newCapacity * sizeof(instruction_t));
+    if (newCode == NULL)
+    {
+        LOG_PRINT(ERROR, "Can't allocate %zu instructions.\n", newCapacity);
+        return false;
+    }
+
+    machineCode->code         = newCode;
+    machineCode->codeCapacity = newCapacity;
+    return true;
+}
+
+
+/**
+ * Old file is instruction count and instructions, it is read to allocated memory.
+ */
+static bool MachineCodeReadOld(MachineCode* machineCode, char* fileName)
+{
+    FILE* machineCodeFile = fopen(fileName, "rb");
+    if (machineCodeFile == NULL)
+        return false;
+
+    fread(&machineCode->instructionCount, sizeof(size_t), 1, machineCodeFile);
+    machineCode->code = (instruction_t*) calloc(machineCode->instructionCount, 
+                                                sizeof(instruction_t));
+    if (machineCode->code == NULL)
+    {
+        fclose(machineCodeFile);
+        return false;
+    }
+
+    fread(machineCode->code, sizeof(instruction_t), machineCode->instructionCount, machineCodeFile);
+    machineCode->instructionNum = 0;
+
+    fclose(machineCodeFile);
+    return true;
+}
+
+
+/**
+ * Check header and section table of mapped file and set code, layout and lines.
+ */
+static bool MachineCodeReadSections(MachineCode* machineCode)
+{
+    // Pages are mapped read-only, code and lines of mapped file are never written.
+    char*        file     = (char*) machineCode->mapped;
+    const size_t fileSize = machineCode->mappedSize;
+    if (fileSize < sizeof(MachineCodeFileHeader))
+        return false;
+
+    const MachineCodeFileHeader* header = (const MachineCodeFileHeader*) file;
+    if (header->version != MACHINE_CODE_FILE_VERSION ||
+        header->sectionCount > (fileSize - sizeof(MachineCodeFileHeader)) / 
+                               sizeof(MachineCodeSection))
+        return false;
+
+    const MachineCodeSection* sections = (const MachineCodeSection*) (header + 1);
+    bool isCodeFound = false;
+    for (size_t sectionNum = 0; sectionNum < header->sectionCount; sectionNum++)
+    {
+        const MachineCodeSection* section = sections + sectionNum;
+        if (section->offset > fileSize || section->size > fileSize - section->offset ||
+            section->offset % sizeof(uint64_t) != 0)
+            return false;
+
+        char* sectionData = file + section->offset;
+        switch (section->type)
+        {
+        case SECTION_CODE:
+#ifdef _DEBUG
+            if (SectionGetChecksum(sectionData, section->size) != section->checksum)
+                return false;
+#endif
+            if (isCodeFound)
+                return false;
+
+            machineCode->code             = (instruction_t*) sectionData;
+            machineCode->instructionCount = section->size / sizeof(instruction_t);
+            isCodeFound = true;
+            break;
+
+        case SECTION_BYTECODE:
+            if (isCodeFound || 
+                SectionGetChecksum(sectionData, section->size) != section->checksum ||
+                !MachineCodeReadBytecode(machineCode, sectionData, section->size))
+                return false;
+
+            isCodeFound = true;
+            break;
+
+        case SECTION_LAYOUT:
+        {
+            uint64_t layoutWords[3] = {};
+            if (section->size != sizeof(layoutWords) ||
+                SectionGetChecksum(sectionData, section->size) != section->checksum)
+                return false;
+
+            memcpy(layoutWords, sectionData, sizeof(layoutWords));
+            machineCode->layout = {
+                .ramSize      = layoutWords[0],
+                .screenWidth  = layoutWords[1],
+                .screenHeight = layoutWords[2],
+            };
+            break;
+        }
+
+        case SECTION_LINES:
+            if (SectionGetChecksum(sectionData, section->size) != section->checksum)
+                return false;
+
+            machineCode->lines     = (MachineCodeLine*) sectionData;
+            machineCode->lineCount = section->size / sizeof(MachineCodeLine);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    machineCode->instructionNum = FIRST_INSTRUCTION_NUM;
+    return isCodeFound;
+}
+
+
+/**
+ * Decode bytecode section to allocated code.
+ */
+static bool MachineCodeReadBytecode(MachineCode* machineCode, const char* section, size_t size)
+{
+    uint64_t instructionCount = 0;
+    if (size < sizeof(instructionCount))
+        return false;
+
+    memcpy(&instructionCount, section, sizeof(instructionCount));
+    const uint8_t* bytecode     = (const uint8_t*) section + sizeof(instructionCount);
+    const size_t   bytecodeSize = size - sizeof(instructionCount);
+
+    // Every byte gives at most two instructions: PUSH and its mode.
+    if (instructionCount > 2 * bytecodeSize)
+        return false;
+
+    instruction_t* code = (instruction_t*) calloc(instructionCount + 1, sizeof(instruction_t));
+    if (code == NULL)
+        return false;
+
+    if (!BytecodeDecode(bytecode, bytecodeSize, code, instructionCount))
+    {
+        free(code);
+        return false;
+    }
+
+    machineCode->code             = code;
+    machineCode->instructionCount = instructionCount;
+    machineCode->isCodeAllocated  = true;
+    return true;
+}
+
+
+/**
+ * @return instruction count and bytecode of written instructions or NULL.
+ */
+static uint8_t* MachineCodeGetBytecodeSection(MachineCode* machineCode, size_t* sizeBuffer)
+{
+    const uint64_t instructionCount = machineCode->instructionNum;
+
+    size_t   bytecodeSize = 0;
+    uint8_t* bytecode     = BytecodeEncode(machineCode->code, instructionCount, &bytecodeSize);
+    if (bytecode == NULL)
+        return NULL;
+
+    uint8_t* section = (uint8_t*) calloc(sizeof(instructionCount) + bytecodeSize, sizeof(uint8_t));
+    if (section != NULL)
+    {
+        memcpy(section, &instructionCount, sizeof(instructionCount));
+        memcpy(section + sizeof(instructionCount), bytecode, bytecodeSize);
+        *sizeBuffer = sizeof(instructionCount) + bytecodeSize;
+    }
+
+    free(bytecode);
+    return section;
+}
+
+
+static uint64_t SectionGetChecksum(const void* section, size_t size)
+{
+    return FnvHashGet(section, size);
+}
@@ -1,25 +1,380 @@
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
 #include "assembler.h"
 #include "processor.h"
 #include "labelArray.h"
+#include "fileProcessor.h"
+#include "machineCode.h"
+#include "batch.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static const char* const DEFAULT_PROGRAM_NAME = "circle.asm";
+
+
+struct Options
+{
+    const char*      programName;
+    const char*      dispatchModeName;
+    ProcessorOptions processorOptions;
+    bool             isBenchmark;
+    bool             isCompact;             /**< Write .vm file with compact bytecode.      */
+    const char*      batchName;             /**< Batch of programs instead of one program.  */
+    BatchOptions     batchOptions;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool OptionsParse(Options* options, int argc, char** argv);
+
+
+static bool OptionGetNumber(const char* optionValue, size_t* numberBuffer);
+
+
+static bool OptionGetSize(const char* optionValue, size_t* sizeBuffer);
+
+
+static bool OptionGetScreen(const char* optionValue, MemoryLayout* layout);
+
+
+static const char* OptionGetValue(const char* arg, const char* optionName);
+
+
+static void UsagePrint(const char* executableName);
+
+
+static void BenchmarkPrint(const char* programName, const char* dispatchModeName, 
+                           ExecutionStats* stats);
+
+
+static void RamUsagePrint(ExecutionStats* stats);
+
+
+static int BatchExecute(Options* options);
 
 
 //--------------------------------------------------------------------------------------------------
 
 
-int main() 
+int main(int argc, char** argv) 
 {
+    Options options = {};
+    if (!OptionsParse(&options, argc, argv))
+    {
+        UsagePrint(argv[0]);
+        return 1;
+    }
+
     LOG_OPEN();
 
-    if (!Assemble("circle.asm"))
+    if (options.batchName != NULL)
+    {
+        int batchResult = BatchExecute(&options);
+        LOG_CLOSE();
+        return batchResult;
+    }
+
+    if (!Assemble(options.programName, options.isCompact))
     {
         ColoredPrintf(RED, "Assembling failed\n");
         LOG_CLOSE();
         return 1;
     }
 
-    if (!ExecuteProgram("circle.vm"))
+    char* machineCodeFileName = NULL;
+    if (!FileNameChangeExtension(options.programName, &machineCodeFileName, ".asm",
+                                                             MACHINE_CODE_FILE_EXTENSION))
+    {
+        ColoredPrintf(RED, "Can't set machine code file name.\n");
+        LOG_CLOSE();
+        return 1;
+    }
+
+    ExecutionStats stats = {};
+    if (!ExecuteProgram(machineCodeFileName, &options.processorOptions, &stats))
         ColoredPrintf(RED, "Executing failed\n");
+    else if (options.isBenchmark)
+        BenchmarkPrint(options.programName, options.dispatchModeName, &stats);
 
+    free(machineCodeFileName);
     LOG_CLOSE();
     return 0;
-}
\ No newline at end of file
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool OptionsParse(Options* options, int argc, char** argv)
+{
+    ProcessorOptions* processorOptions = &options->processorOptions;
+
+    options->programName      = DEFAULT_PROGRAM_NAME;
+    options->dispatchModeName = "threaded";
+    options->isBenchmark      = false;
+    options->isCompact        = false;
+    options->batchName        = NULL;
+    options->batchOptions     = {.processorOptions = processorOptions};
+    *processorOptions         = {.dispatchMode = DISPATCH_THREADED};
+
+    for (int argNum = 1; argNum < argc; argNum++)
+    {
+        const char* arg         = argv[argNum];
+        const char* optionValue = NULL;
+
+        if ((optionValue = OptionGetValue(arg, "--dispatch=")) != NULL)
+        {
+            options->dispatchModeName = optionValue;
+            if (!DispatchModeFromString(optionValue, &processorOptions->dispatchMode))
+                return false;
+        }
+        else if ((optionValue = OptionGetValue(arg, "--pair-profile=")) != NULL)
+            processorOptions->pairProfileName = optionValue;
+        else if ((optionValue = OptionGetValue(arg, "--pair-profile-write=")) != NULL)
+            processorOptions->pairProfileWriteName = optionValue;
+        else if ((optionValue = OptionGetValue(arg, "--tier-threshold=")) != NULL)
+        {
+            if (!OptionGetNumber(optionValue, &processorOptions->tierUpThreshold))
+                return false;
+        }
+        else if ((optionValue = OptionGetValue(arg, "--batch=")) != NULL)
+            options->batchName = optionValue;
+        else if ((optionValue = OptionGetValue(arg, "--threads=")) != NULL)
+        {
+            if (!OptionGetNumber(optionValue, &options->batchOptions.threadCount))
+                return false;
+        }
+        else if ((optionValue = OptionGetValue(arg, "--instruction-limit=")) != NULL)
+        {
+            if (!OptionGetNumber(optionValue, &options->batchOptions.instructionLimit))
+                return false;
+        }
+        else if ((optionValue = OptionGetValue(arg, "--io=")) != NULL)
+        {
+            if (!IoModeFromString(optionValue, &processorOptions->ioMode))
+                return false;
+        }
+        else if ((optionValue = OptionGetValue(arg, "--draw=")) != NULL)
+        {
+            if (!DrawModeFromString(optionValue, &processorOptions->drawMode))
+                return false;
+        }
+        else if ((optionValue = OptionGetValue(arg, "--frames=")) != NULL)
+            processorOptions->frameFileName = optionValue;
+        else if ((optionValue = OptionGetValue(arg, "--frame-step=")) != NULL)
+        {
+            if (!OptionGetNumber(optionValue, &processorOptions->frameStep))
+                return false;
+        }
+        else if ((optionValue = OptionGetValue(arg, "--ram=")) != NULL)
+        {
+            if (!OptionGetSize(optionValue, &processorOptions->layout.ramSize) ||
+                processorOptions->layout.ramSize == 0)
+                return false;
+        }
+        else if ((optionValue = OptionGetValue(arg, "--screen=")) != NULL)
+        {
+            if (!OptionGetScreen(optionValue, &processorOptions->layout))
+                return false;
+        }
+        else if (strcmp(arg, "--ram-guard") == 0)
+            processorOptions->isRamGuarded = true;
+        else if (strcmp(arg, "--frame-hash") == 0)
+            processorOptions->isFrameHashOnly = true;
+        else if (strcmp(arg, "--tier-report") == 0)
+            processorOptions->isTierReportNeeded = true;
+        else if (strcmp(arg, "--bench") == 0)
+            options->isBenchmark = true;
+        else if (strcmp(arg, "--compact") == 0)
+            options->isCompact = true;
+        else if (arg[0] != '-')
+            options->programName = arg;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+
+static const char* OptionGetValue(const char* arg, const char* optionName)
+{
+    const size_t optionNameLength = strlen(optionName);
+    if (strncmp(arg, optionName, optionNameLength) != 0)
+        return NULL;
+
+    return arg + optionNameLength;
+}
+
+
+static bool OptionGetNumber(const char* optionValue, size_t* numberBuffer)
+{
+    char* valueEnd = NULL;
+    *numberBuffer  = strtoul(optionValue, &valueEnd, 10);
+
+    return *optionValue != '\0' && *valueEnd == '\0';
+}
+
+
+/**
+ * Number which may have suffix K, M or G of 2^10, 2^20 or 2^30.
+ */
+static bool OptionGetSize(const char* optionValue, size_t* sizeBuffer)
+{
+    char* valueEnd = NULL;
+    *sizeBuffer    = strtoul(optionValue, &valueEnd, 10);
+    if (valueEnd == optionValue)
+        return false;
+
+    size_t shift = 0;
+    switch (*valueEnd)
+    {
+    case '\0':
+        return true;
+
+    case 'K':
+        shift = 10;
+        break;
+
+    case 'M':
+        shift = 20;
+        break;
+
+    case 'G':
+        shift = 30;
+        break;
+
+    default:
+        return false;
+    }
+
+    if (valueEnd[1] != '\0' || *sizeBuffer > (SIZE_MAX >> shift))
+        return false;
+
+    *sizeBuffer <<= shift;
+    return true;
+}
+
+
+/**
+ * Screen is WIDTHxHEIGHT, both are positive.
+ */
+static bool OptionGetScreen(const char* optionValue, MemoryLayout* layout)
+{
+    char* valueEnd = NULL;
+    layout->screenWidth = strtoul(optionValue, &valueEnd, 10);
+    if (valueEnd == optionValue || *valueEnd != 'x')
+        return false;
+
+    const char* heightString = valueEnd + 1;
+    layout->screenHeight = strtoul(heightString, &valueEnd, 10);
+
+    return valueEnd != heightString && *valueEnd == '\0' && 
+           layout->screenWidth != 0 && layout->screenHeight != 0;
+}
+
+
+static void UsagePrint(const char* executableName)
+{
+    ColoredPrintf(RED, "Usage: %s [options] [program.asm]\n"
+                       "Options:\n"
+                       "\t--dispatch=switch|threaded|decoded|fused|jit|tiered\n"
+                       "\t--pair-profile=FILE        choose superinstructions by pair profile\n"
+                       "\t--pair-profile-write=FILE  write pair profile of decoded commands\n"
+                       "\t--tier-threshold=N         jumps or calls which make region hot\n"
+                       "\t--tier-report              print hot regions and time of every tier\n"
+                       "\t--io=colored|text|binary   format of IN and OUT, text and binary\n"
+                       "\t                           are buffered until FLUSH or exit\n"
+                       "\t--draw=auto|full|diff      DRAW prints every frame or only changed\n"
+                       "\t                           pixels, auto is diff on terminal\n"
+                       "\t--frames=FILE              headless DRAW, frames are added to FILE\n"
+                       "\t--frame-step=N             keep only every N-th frame\n"
+                       "\t--frame-hash               keep only hashes of frames\n"
+                       "\t--ram=N[K|M|G]             cells of RAM, overrides .ram of program\n"
+                       "\t--screen=WxH               screen size, overrides .screen of program\n"
+                       "\t--ram-guard                trap cells out of RAM by guard pages\n"
+                       "\t                           instead of checks in decoded and fused,\n"
+                       "\t                           cells are masked by window of 2^24 cells\n"
+                       "\t                           or power of 2 above RAM size, so cell\n"
+                       "\t                           window + k is the same as cell k\n"
+                       "\t--bench                    print executed instructions per second\n"
+                       "\t--compact                  write .vm file with variable-length\n"
+                       "\t                           bytecode, it is expanded at load\n"
+                       "\t--batch=FILE               run jobs from FILE, every line is\n"
+                       "\t                           program.asm and its input numbers\n"
+                       "\t--threads=N                threads of batch, default is core count\n"
+                       "\t--instruction-limit=N      stop batch job after N instructions\n",
+                  executableName);
+}
+
+
+static void BenchmarkPrint(const char* programName, const char* dispatchModeName, 
+                           ExecutionStats* stats)
+{
+    // Native code doesn't count executed instructions.
+    if (stats->executedCount == 0)
+    {
+        ColoredPrintf(GREEN, "%s [%s]: %.6lf s\n", 
+                      programName, dispatchModeName, stats->executionSeconds);
+        RamUsagePrint(stats);
+        return;
+    }
+
+    double instructionsPerSecond = 0;
+    if (stats->executionSeconds > 0)
+        instructionsPerSecond = (double) stats->executedCount / stats->executionSeconds;
+
+    ColoredPrintf(GREEN, "%s [%s]: %zu instructions in %.6lf s, %.2lf M instructions/s\n",
+                  programName, dispatchModeName, stats->executedCount, stats->executionSeconds,
+                  instructionsPerSecond * 1e-6);
+    RamUsagePrint(stats);
+}
+
+
+static void RamUsagePrint(ExecutionStats* stats)
+{
+    ColoredPrintf(GREEN, "RAM: %zu KiB resident of %zu KiB\n", 
+                  stats->ramResidentSize / 1024, stats->ramSize / 1024);
+}
+
+
+/**
+ * Batch jobs are run on decoded or fused code, other dispatch modes can't be resumed.
+ */
+static int BatchExecute(Options* options)
+{
+    Batch batch = {};
+    if (!BatchInitFromFile(&batch, options->batchName))
+        return 1;
+
+    BatchStats stats = {};
+    if (!BatchRun(&batch, &options->batchOptions, &stats))
+    {
+        ColoredPrintf(RED, "Executing batch failed\n");
+        BatchDelete(&batch);
+        return 1;
+    }
+
+    if (options->isBenchmark)
+    {
+        double instructionsPerSecond = 0;
+        if (stats.executionSeconds > 0)
+            instructionsPerSecond = (double) stats.executedCount / stats.executionSeconds;
+
+        ColoredPrintf(GREEN, "%s [%zu threads]: %zu jobs, %zu stolen, %zu instructions in "
+                             "%.6lf s, %.2lf M instructions/s\n",
+                      options->batchName, stats.threadCount, batch.jobCount, stats.stolenCount,
+                      stats.executedCount, stats.executionSeconds, instructionsPerSecond * 1e-6);
+    }
+    else
+        BatchPrintResults(&batch);
+
+    BatchDelete(&batch);
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "mnemonics.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * Slots of hash table, power of 2. Names take less than a quarter of slots,
+ * so seed of perfect hash is found in a few attempts.
+ */
+static const size_t MNEMONIC_TABLE_SIZE = 128;
+
+static const uint32_t MNEMONIC_MAX_SEED = 1 << 16;
+
+static const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+static const uint32_t FNV_PRIME        = 16777619u;
+
+
+/**
+ * Slot has number of name. Number 0 is "WRONG", it isn't in table and marks empty slot.
+ */
+struct MnemonicTable
+{
+    uint32_t seed;              /**< MNEMONIC_MAX_SEED if there is no perfect hash.  */
+    uint8_t  slots[MNEMONIC_TABLE_SIZE];
+};
+
+
+#define DEF_CMD_(CMD_NAME, ...) \
+    , GET_NAME(CMD_NAME)
+
+static constexpr const char* CMD_NAMES[] =
+{
+    "WRONG"
+    #include "commands.h"
+};
+#undef DEF_CMD_
+
+static const size_t CMD_NAME_COUNT = sizeof(CMD_NAMES) / sizeof(CMD_NAMES[0]);
+
+
+#define DEF_REGISTER_(REGISTER_NAME) \
+    , GET_NAME(REGISTER_NAME)
+
+static constexpr const char* REGISTER_NAMES[] =
+{
+    "WRONG"
+    #include "registers.h"
+};
+#undef DEF_REGISTER_
+
+static const size_t REGISTER_NAME_COUNT = sizeof(REGISTER_NAMES) / sizeof(REGISTER_NAMES[0]);
+
+static_assert(CMD_NAME_COUNT      <= MNEMONIC_TABLE_SIZE / 4, "Too many commands for table");
+static_assert(REGISTER_NAME_COUNT <= MNEMONIC_TABLE_SIZE / 4, "Too many registers for table");
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+// Tables are built by compiler, so these functions are defined before them.
+
+/**
+ * FNV-1a with seed mixed into offset basis.
+ */
+static constexpr uint32_t NameGetHash(const char* name, uint32_t seed)
+{
+    uint32_t hash = FNV_OFFSET_BASIS ^ (seed * FNV_PRIME);
+    for (size_t charNum = 0; name[charNum] != '\0'; charNum++)
+    {
+        hash ^= (unsigned char) name[charNum];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+
+/**
+ * Try seeds until every name gets its own slot.
+ */
+static constexpr MnemonicTable MnemonicTableBuild(const char* const* names, size_t nameCount)
+{
+    for (uint32_t seed = 0; seed < MNEMONIC_MAX_SEED; seed++)
+    {
+        MnemonicTable table   = {.seed = seed, .slots = {}};
+        bool          isFound = true;
+        for (size_t nameNum = 1; isFound && nameNum < nameCount; nameNum++)
+        {
+            const size_t slotNum = NameGetHash(names[nameNum], seed) & (MNEMONIC_TABLE_SIZE - 1);
+            if (table.slots[slotNum] != 0)
+                isFound = false;
+
+            table.slots[slotNum] = (uint8_t) nameNum;
+        }
+
+        if (isFound)
+            return table;
+    }
+
+    return {.seed = MNEMONIC_MAX_SEED, .slots = {}};
+}
+
+
+static constexpr MnemonicTable CMD_TABLE      = MnemonicTableBuild(CMD_NAMES, CMD_NAME_COUNT);
+static constexpr MnemonicTable REGISTER_TABLE = MnemonicTableBuild(REGISTER_NAMES,
+                                                                   REGISTER_NAME_COUNT);
+
+static_assert(CMD_TABLE.seed      != MNEMONIC_MAX_SEED, "No perfect hash of command names");
+static_assert(REGISTER_TABLE.seed != MNEMONIC_MAX_SEED, "No perfect hash of register names");
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static size_t MnemonicTableFind(const MnemonicTable* table, const char* const* names,
+                                const char* string);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+cmdName_t CmdNameFromString(const char* string)
+{
+    return (cmdName_t) MnemonicTableFind(&CMD_TABLE, CMD_NAMES, string);
+}
+
+
+const char* CmdNameToString(instruction_t cmdName)
+{
+    if (cmdName <= 0 || (size_t) cmdName >= CMD_NAME_COUNT)
+        return CMD_NAMES[CMD_NAME_WRONG];
+
+    return CMD_NAMES[cmdName];
+}
+
+
+registerName_t RegisterNameFromString(const char* string)
+{
+    return (registerName_t) MnemonicTableFind(&REGISTER_TABLE, REGISTER_NAMES, string);
+}
+
+
+const char* RegisterNameToString(instruction_t registerName)
+{
+    if (registerName <= 0 || (size_t) registerName >= REGISTER_NAME_COUNT)
+        return REGISTER_NAMES[REGISTER_NAME_WRONG];
+
+    return REGISTER_NAMES[registerName];
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * @return number of name or 0 if string isn't a name.
+ */
+static size_t MnemonicTableFind(const MnemonicTable* table, const char* const* names,
+                                const char* string)
+{
+    const size_t slotNum = NameGetHash(string, table->seed) & (MNEMONIC_TABLE_SIZE - 1);
+    const size_t nameNum = table->slots[slotNum];
+    if (nameNum == 0 || strcmp(names[nameNum], string) != 0)
+        return 0;
+
+    return nameNum;
+}
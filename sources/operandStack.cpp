@@ -0,0 +1,73 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "operandStack.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool OperandStackInit(OperandStack* operandStack, size_t capacity)
+{
+    // +1 for data[0] which is never used
+    operandStack->data = (instruction_t*) calloc(capacity + 1, sizeof(instruction_t));
+    if (operandStack->data == NULL)
+        return false;
+
+    operandStack->top      = operandStack->data;
+    operandStack->topValue = 0;
+    operandStack->capacity = capacity;
+
+    return true;
+}
+
+
+void OperandStackDelete(OperandStack* operandStack)
+{
+    free(operandStack->data);
+
+    operandStack->data     = NULL;
+    operandStack->top      = NULL;
+    operandStack->topValue = 0;
+    operandStack->capacity = 0;
+}
+
+
+size_t OperandStackGetSize(OperandStack* operandStack)
+{
+    return (size_t) (operandStack->top - operandStack->data);
+}
+
+
+bool OperandStackReserve(OperandStack* operandStack, size_t capacity)
+{
+    if (capacity <= operandStack->capacity)
+        return true;
+
+    const size_t   size    = OperandStackGetSize(operandStack);
+    instruction_t* newData = (instruction_t*) realloc(operandStack->data, 
+                                                      (capacity + 1) * sizeof(instruction_t));
+    if (newData == NULL)
+        return false;
+
+    operandStack->data     = newData;
+    operandStack->top      = newData + size;
+    operandStack->capacity = capacity;
+
+    return true;
+}
+
+
+bool OperandStackCopy(OperandStack* source, OperandStack* copy)
+{
+    if (!OperandStackInit(copy, source->capacity))
+        return false;
+
+    const size_t size = OperandStackGetSize(source);
+    memcpy(copy->data, source->data, (size + 1) * sizeof(instruction_t));
+
+    copy->top      = copy->data + size;
+    copy->topValue = source->topValue;
+
+    return true;
+}
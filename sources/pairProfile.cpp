@@ -0,0 +1,201 @@
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pairProfile.h"
+#include "decodedCode.h"
+#include "virtualMachine.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+struct PairCount
+{
+    size_t firstCmd;
+    size_t secondCmd;
+    size_t count;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static int PairCountCompare(const void* firstPairPtr, const void* secondPairPtr);
+
+static bool CmdNameRead(FILE* file, char* nameBuffer);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool PairProfileInit(PairProfile* pairProfile, size_t cmdCount)
+{
+    pairProfile->pairCounts = (size_t*) calloc(cmdCount * cmdCount, sizeof(size_t));
+    if (pairProfile->pairCounts == NULL)
+        return false;
+
+    pairProfile->cmdCount  = cmdCount;
+    pairProfile->pairCount = 0;
+
+    return true;
+}
+
+
+void PairProfileDelete(PairProfile* pairProfile)
+{
+    free(pairProfile->pairCounts);
+
+    pairProfile->pairCounts = NULL;
+    pairProfile->cmdCount   = 0;
+    pairProfile->pairCount  = 0;
+}
+
+
+size_t PairProfileGetCount(PairProfile* pairProfile, size_t firstCmd, size_t secondCmd)
+{
+    if (firstCmd >= pairProfile->cmdCount || secondCmd >= pairProfile->cmdCount)
+        return 0;
+
+    return pairProfile->pairCounts[firstCmd * pairProfile->cmdCount + secondCmd];
+}
+
+
+bool PairProfileIsHot(PairProfile* pairProfile, size_t firstCmd, size_t secondCmd)
+{
+    size_t count = PairProfileGetCount(pairProfile, firstCmd, secondCmd);
+
+    return count != 0 && count * PAIR_PROFILE_HOT_DIVIDER >= pairProfile->pairCount;
+}
+
+
+bool PairProfileWriteToFile(PairProfile* pairProfile, const char* fileName)
+{
+    const size_t cmdCount = pairProfile->cmdCount;
+
+    PairCount* pairs = (PairCount*) calloc(cmdCount * cmdCount, sizeof(PairCount));
+    if (pairs == NULL)
+        return false;
+
+    size_t executedPairCount = 0;
+    for (size_t firstCmd = 0; firstCmd < cmdCount; firstCmd++)
+        for (size_t secondCmd = 0; secondCmd < cmdCount; secondCmd++)
+        {
+            size_t count = PairProfileGetCount(pairProfile, firstCmd, secondCmd);
+            if (count != 0)
+                pairs[executedPairCount++] = {.firstCmd  = firstCmd, 
+                                              .secondCmd = secondCmd, 
+                                              .count     = count};
+        }
+
+    qsort(pairs, executedPairCount, sizeof(PairCount), PairCountCompare);
+
+    FILE* file = fopen(fileName, "w");
+    if (file == NULL)
+    {
+        ColoredPrintf(RED, "Can't write pair profile to %s.\n", fileName);
+        free(pairs);
+        return false;
+    }
+
+    for (size_t pairNum = 0; pairNum < executedPairCount; pairNum++)
+        fprintf(file, "%s %s %zu\n", DecodedCmdGetName((decodedCmdName_t) pairs[pairNum].firstCmd),
+                                     DecodedCmdGetName((decodedCmdName_t) pairs[pairNum].secondCmd),
+                                     pairs[pairNum].count);
+
+    fclose(file);
+    free(pairs);
+    return true;
+}
+
+
+bool PairProfileInitFromFile(PairProfile* pairProfile, size_t cmdCount, const char* fileName)
+{
+    FILE* file = fopen(fileName, "r");
+    if (file == NULL)
+    {
+        ColoredPrintf(RED, "Can't read pair profile from %s.\n", fileName);
+        return false;
+    }
+
+    if (!PairProfileInit(pairProfile, cmdCount))
+    {
+        fclose(file);
+        return false;
+    }
+
+    char firstName[MAX_CMD_LENGTH + 1]  = {};
+    char secondName[MAX_CMD_LENGTH + 1] = {};
+    size_t count = 0;
+
+    while (CmdNameRead(file, firstName) && CmdNameRead(file, secondName) && 
+           fscanf(file, "%zu", &count) == 1)
+    {
+        decodedCmdName_t firstCmd  = DECODED_CMD_NAME_WRONG;
+        decodedCmdName_t secondCmd = DECODED_CMD_NAME_WRONG;
+        if (!DecodedCmdFromName(firstName,  &firstCmd) || 
+            !DecodedCmdFromName(secondName, &secondCmd))
+        {
+            // Profile can be collected by older version with other commands.
+            LOG_PRINT(INFO, "Unknown pair %s %s in pair profile.\n", firstName, secondName);
+            continue;
+        }
+
+        pairProfile->pairCounts[(size_t) firstCmd * cmdCount + (size_t) secondCmd] += count;
+        pairProfile->pairCount += count;
+    }
+
+    fclose(file);
+    return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static int PairCountCompare(const void* firstPairPtr, const void* secondPairPtr)
+{
+    const PairCount* firstPair  = (const PairCount*) firstPairPtr;
+    const PairCount* secondPair = (const PairCount*) secondPairPtr;
+
+    if (firstPair->count > secondPair->count)
+        return -1;
+
+    if (firstPair->count < secondPair->count)
+        return 1;
+
+    return 0;
+}
+
+
+/**
+ * Reads word to nameBuffer of MAX_CMD_LENGTH + 1 chars. Longer word is skipped 
+ * and empty name is returned, so it isn't found among commands.
+ * 
+ * @return false if there are no words anymore.
+ */
+static bool CmdNameRead(FILE* file, char* nameBuffer)
+{
+    int symbol = getc(file);
+    while (isspace(symbol))
+        symbol = getc(file);
+
+    if (symbol == EOF)
+        return false;
+
+    size_t nameLength = 0;
+    for (; symbol != EOF && !isspace(symbol); symbol = getc(file))
+    {
+        if (nameLength <= MAX_CMD_LENGTH)
+            nameBuffer[nameLength] = (char) symbol;
+
+        nameLength++;
+    }
+
+    if (nameLength > MAX_CMD_LENGTH)
+        nameLength = 0;
+
+    nameBuffer[nameLength] = '\0';
+    return true;
+}
@@ -3,32 +3,121 @@
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <setjmp.h>
+#include <atomic>
 
 #include "processor.h"
 #include "virtualMachine.h"
 #include "machineCode.h"
+#include "decodedCode.h"
 #include "logPrinter.h"
 #include "stack.h"
+#include "operandStack.h"
+#include "jit.h"
+#include "hotRegions.h"
+#include "verifier.h"
 #include "RAM.h"
+#include "ioChannel.h"
+#include "frameRenderer.h"
 
 
 //--------------------------------------------------------------------------------------------------
 
 
+struct HostFunction
+{
+    hostFunction_t function;
+    void*          context;
+};
+
+
 struct Processor
 {
     MachineCode machineCode;
+    DecodedCode decodedCode;
+    JitCode jitCode;
+#ifdef _DEBUG
     Stack* stack;
+#else
+    OperandStack operandStack;
+#endif
     Stack* callStack;
     Registers64 registers;
     RAM ram;
+    IoChannel io;                       /**< IN and OUT of ExecuteProgram().               */
+    FrameRenderer renderer;             /**< Screen of DRAW.                               */
+    size_t executedCount;
+    bool isVerified;
+    size_t verifiedDepth;               /**< The deepest operand stack of verified code.     */
+    bool isMachineCodeShared;           /**< Code is owned by ProcessorCreateFromCode() caller. */
+
+    processorStatus_t status;           /**< Status of the last ProcessorRun().            */
+    size_t decodedNum;                  /**< Next decoded instruction for ProcessorRun().  */
+    instruction_t* inputs;              /**< Numbers for IN given by ProcessorInputAdd().  */
+    size_t inputCount;
+    size_t inputCapacity;
+    size_t inputNum;
+    char* output;                       /**< Text printed by OUT for ProcessorGetOutput().  */
+    size_t outputLength;
+    size_t outputCapacity;
+    HostFunction* hostFunctions;        /**< Functions of SYSCALL by their numbers.         */
+    size_t hostFunctionCount;
+    DecodedInstruction* ramInstruction; /**< The last instruction which accesses guarded RAM. */
 };
 
 
+/**
+ * Part of decoded code which is executed by ProgramRunDecoded() in tiered and budgeted runs.
+ */
+struct DecodedRange
+{
+    size_t beginNum;
+    size_t endNum;
+    size_t entryNum;
+    size_t exitNum;         /**< Next instruction when execution is stopped.              */
+    size_t executedLimit;   /**< Budgeted run stops when executedCount reaches it.        */
+};
+
+
+/**
+ * Variants of ProgramRunDecoded().
+ */
+enum DECODED_RUN_FLAGS
+{
+    RUN_PROFILING = 1 << 0,     /**< Pairs of executed commands are counted.              */
+    RUN_TIERED    = 1 << 1,     /**< Only range is executed, call stack keeps code words.  */
+    RUN_VERIFIED  = 1 << 2,     /**< Program is verified, so it is the only unchecked run. */
+    RUN_BUDGETED  = 1 << 3,     /**< Run is stopped by budget or missed input.             */
+    RUN_GUARDED   = 1 << 4,     /**< RAM is guarded, so cells are masked instead of checks. */
+};
+
+
+/**
+ * Check time once in this number of instructions when run has time budget.
+ */
+static const size_t TIME_BUDGET_CHECK_PERIOD = 1 << 16;
+
+static const size_t INPUTS_MIN_CAPACITY = 16;
+
+static const size_t STACK_COPY_MIN_CAPACITY = 16;
+
+static const size_t OUTPUT_MIN_CAPACITY = 256;
+
+/**
+ * Maximal length of one number printed by OUT with '\n' and '\0'.
+ */
+static const size_t OUTPUT_NUMBER_MAX_LENGTH = IO_NUMBER_MAX_LENGTH + 2;
+
+
 //--------------------------------------------------------------------------------------------------
 
 
-static void ProcessorInit(Processor* processor, const char* programName);
+static bool ProcessorInit(Processor* processor, const char* programName);
+
+
+static bool ProcessorRamInit(Processor* processor, ProcessorOptions* options);
 
 
 static void ProcessorDelete(Processor* processor);
@@ -37,52 +126,709 @@ static void ProcessorDelete(Processor* processor);
 static bool InstructionExecute(Processor* processor);
 
 
+static bool ProgramRunSwitch(Processor* processor);
+
+
+static bool ProgramRunThreaded(Processor* processor);
+
+
+static bool ProcessorDecode(Processor* processor, ProcessorOptions* options);
+
+
+static bool ProgramRunGuarded(Processor* processor);
+
+
+static bool ConstCellsAreGuarded(Processor* processor);
+
+
+template <unsigned RUN_FLAGS>
+static bool ProgramRunDecoded(Processor* processor, PairProfile* pairProfile, 
+                              DecodedRange* range);
+
+
+static bool ProcessorInputGet(Processor* processor, instruction_t* valueBuffer);
+
+
+static bool ProcessorOutputAdd(Processor* processor, instruction_t value);
+
+
+static Processor* ProcessorCreateDecoded(Processor* processor, ProcessorOptions* options);
+
+
+static bool ProcessorStackCopy(Stack* source, Stack** copyPtr);
+
+
+static bool ProcessorHostFunctionCall(Processor* processor, instruction_t functionNum);
+
+
+static bool ProgramRunTiered(Processor* processor, ProcessorOptions* options,
+                             HotRegions* hotRegions, double startSeconds);
+
+
+static HotRegion* ProcessorTierUp(Processor* processor, ProcessorOptions* options, 
+                                  HotRegions* hotRegions, size_t jumpNum, size_t targetNum,
+                                  bool isCall, double startSeconds);
+
+
+static bool CmdIsJump(instruction_t cmdName);
+
+
+#ifdef _DEBUG
+    #define OPERAND_STACK_CACHE_()
+    #define OPERAND_STACK_FLUSH_()
+    #define OPERAND_STACK_RELOAD_()
+#else
+    // Local copy of operand stack lets compiler keep top element and stack pointer in registers.
+    // Flush and reload do nothing if OPERAND_STACK_ is operand stack of processor itself.
+    #define OPERAND_STACK_CACHE_() \
+        OperandStack operandStack = processor->operandStack
+
+    #define OPERAND_STACK_FLUSH_() \
+        processor->operandStack = OPERAND_STACK_
+
+    #define OPERAND_STACK_RELOAD_() \
+        OPERAND_STACK_ = processor->operandStack
+#endif
+
+// Host function uses operand stack of processor, so local copy is flushed before the call.
+#define HOST_FUNCTION_CALL_(FUNCTION_NUM)                                               \
+{                                                                                       \
+    OPERAND_STACK_FLUSH_();                                                             \
+    bool isHostFunctionCalled_ = ProcessorHostFunctionCall(processor, FUNCTION_NUM);    \
+    OPERAND_STACK_RELOAD_();                                                            \
+                                                                                        \
+    if (!isHostFunctionCalled_)                                                         \
+        return false;                                                                   \
+}
+
+
 //--------------------------------------------------------------------------------------------------
 
 
-bool ExecuteProgram(const char* programName)
+bool ExecuteProgram(const char* programName, ProcessorOptions* options, ExecutionStats* stats)
 {
+    ProcessorOptions defaultOptions = {.dispatchMode = DISPATCH_THREADED};
+    if (options == NULL)
+        options = &defaultOptions;
+
+    const dispatchMode_t dispatchMode = options->dispatchMode;
+    const bool isDecoded = (dispatchMode == DISPATCH_DECODED || dispatchMode == DISPATCH_FUSED ||
+                            dispatchMode == DISPATCH_JIT);
+
     Processor processor = {};
-    ProcessorInit(&processor, programName);
+    if (!ProcessorInit(&processor, programName) ||
+        !ProcessorRamInit(&processor, options) ||
+        !IoChannelInit(&processor.io, options->ioMode, STDIN_FILENO, STDOUT_FILENO))
+    {
+        ProcessorDelete(&processor);
+        return false;
+    }
+    FrameRendererInit(&processor.renderer, options->drawMode, &processor.io);
 
-    while (processor.machineCode.instructionNum < processor.machineCode.instructionCount)
+    if (options->frameFileName != NULL &&
+        !FrameRendererCaptureOpen(&processor.renderer, options->frameFileName, 
+                                  processor.ram.screenWidth, processor.ram.screenHeight,
+                                  options->frameStep, options->isFrameHashOnly))
     {
-        // printf("%zu\n", processor.machineCode.instructionNum);
-        if (!InstructionExecute(&processor))
+        ColoredPrintf(RED, "Can't create frame file %s.\n", options->frameFileName);
+        ProcessorDelete(&processor);
+        return false;
+    }
+
+    if (isDecoded && !ProcessorDecode(&processor, options))
+    {
+        ColoredPrintf(RED, "Can't decode %s.\n", programName);
+        ProcessorDelete(&processor);
+        return false;
+    }
+
+    PairProfile pairProfile = {};
+    const bool isProfiling = isDecoded && dispatchMode != DISPATCH_JIT && 
+                             options->pairProfileWriteName != NULL;
+    if (isProfiling && !PairProfileInit(&pairProfile, DECODED_CMD_COUNT))
+    {
+        ProcessorDelete(&processor);
+        return false;
+    }
+
+    HotRegions hotRegions = {};
+    if (dispatchMode == DISPATCH_TIERED && 
+        !HotRegionsInit(&hotRegions, processor.machineCode.instructionCount, 
+                        options->tierUpThreshold))
+    {
+        ProcessorDelete(&processor);
+        return false;
+    }
+
+    bool isJitCompiled = false;
+    if (dispatchMode == DISPATCH_JIT && processor.isVerified)
+    {
+        isJitCompiled = JitCodeInit(&processor.jitCode, &processor.decodedCode, 
+                                    &processor.registers, &processor.ram, &processor.io,
+                                    &processor.renderer, processor.verifiedDepth + 1);
+        if (!isJitCompiled)
+            LOG_PRINT(INFO, "Can't compile %s, decoded dispatch is used.\n", programName);
+    }
+
+    double startSeconds = GetSeconds();
+
+    bool executionResult = false;
+    switch (dispatchMode)
+    {
+    case DISPATCH_SWITCH:
+        executionResult = ProgramRunSwitch(&processor);
+        break;
+
+    case DISPATCH_THREADED:
+        executionResult = ProgramRunThreaded(&processor);
+        break;
+
+    case DISPATCH_DECODED:
+    case DISPATCH_FUSED:
+        if (isProfiling)
+            executionResult = ProgramRunDecoded<RUN_PROFILING>(&processor, &pairProfile, NULL);
+        else if (processor.ram.mask != 0)
+            executionResult = ProgramRunGuarded(&processor);
+        else if (processor.isVerified)
+            executionResult = ProgramRunDecoded<RUN_VERIFIED>(&processor, NULL, NULL);
+        else
+            executionResult = ProgramRunDecoded<0>(&processor, NULL, NULL);
+        break;
+
+    case DISPATCH_JIT:
+        if (isJitCompiled)
+            executionResult = JitCodeRun(&processor.jitCode);
+        else
+            executionResult = ProgramRunDecoded<0>(&processor, NULL, NULL);
+        break;
+
+    case DISPATCH_TIERED:
+        executionResult = ProgramRunTiered(&processor, options, &hotRegions, startSeconds);
+        break;
+
+    default:
+        LOG_PRINT(ERROR, "Wrong dispatchMode = %d\n", dispatchMode);
+        break;
+    }
+
+    const double executionSeconds = GetSeconds() - startSeconds;
+    if (stats != NULL)
+    {
+        stats->executedCount    = processor.executedCount;
+        stats->executionSeconds = executionSeconds;
+        stats->ramSize          = processor.ram.size * sizeof(memoryCell_t);
+        stats->ramResidentSize  = ProcessorGetRamResidentSize(&processor);
+    }
+
+    if (dispatchMode == DISPATCH_TIERED)
+    {
+        if (options->isTierReportNeeded)
+            HotRegionsPrint(&hotRegions, executionSeconds);
+
+        HotRegionsDelete(&hotRegions);
+    }
+
+    if (isProfiling)
+    {
+        PairProfileWriteToFile(&pairProfile, options->pairProfileWriteName);
+        PairProfileDelete(&pairProfile);
+    }
+
+    ProcessorDelete(&processor);
+    return executionResult;
+}
+
+
+bool DispatchModeFromString(const char* string, dispatchMode_t* dispatchModeBuffer)
+{
+    if (strcmp(string, "switch") == 0)
+    {
+        *dispatchModeBuffer = DISPATCH_SWITCH;
+        return true;
+    }
+
+    if (strcmp(string, "threaded") == 0)
+    {
+        *dispatchModeBuffer = DISPATCH_THREADED;
+        return true;
+    }
+
+    if (strcmp(string, "decoded") == 0)
+    {
+        *dispatchModeBuffer = DISPATCH_DECODED;
+        return true;
+    }
+
+    if (strcmp(string, "fused") == 0)
+    {
+        *dispatchModeBuffer = DISPATCH_FUSED;
+        return true;
+    }
+
+    if (strcmp(string, "jit") == 0)
+    {
+        *dispatchModeBuffer = DISPATCH_JIT;
+        return true;
+    }
+
+    if (strcmp(string, "tiered") == 0)
+    {
+        *dispatchModeBuffer = DISPATCH_TIERED;
+        return true;
+    }
+
+    return false;
+}
+
+
+double GetSeconds()
+{
+    timespec time = {};
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (double) time.tv_sec + (double) time.tv_nsec * 1e-9;
+}
+
+
+Processor* ProcessorCreate(const char* programName, ProcessorOptions* options)
+{
+    Processor* processor = (Processor*) calloc(1, sizeof(Processor));
+    if (processor == NULL)
+        return NULL;
+
+    if (!ProcessorInit(processor, programName))
+    {
+        ProcessorDestroy(processor);
+        return NULL;
+    }
+
+    if (processor->machineCode.code == NULL)
+    {
+        ColoredPrintf(RED, "Can't load %s.\n", programName);
+        ProcessorDestroy(processor);
+        return NULL;
+    }
+
+    if (!ProcessorRamInit(processor, options))
+    {
+        ProcessorDestroy(processor);
+        return NULL;
+    }
+
+    return ProcessorCreateDecoded(processor, options);
+}
+
+
+Processor* ProcessorCreateFromCode(const MachineCode* machineCode, ProcessorOptions* options)
+{
+    Processor* processor = (Processor*) calloc(1, sizeof(Processor));
+    if (processor == NULL)
+        return NULL;
+
+    if (!ProcessorInit(processor, NULL))
+    {
+        ProcessorDestroy(processor);
+        return NULL;
+    }
+
+    processor->machineCode                = *machineCode;
+    processor->machineCode.instructionNum = FIRST_INSTRUCTION_NUM;
+    processor->isMachineCodeShared        = true;
+
+    if (!ProcessorRamInit(processor, options))
+    {
+        ProcessorDestroy(processor);
+        return NULL;
+    }
+
+    return ProcessorCreateDecoded(processor, options);
+}
+
+
+void ProcessorDestroy(Processor* processor)
+{
+    if (processor == NULL)
+        return;
+
+    ProcessorDelete(processor);
+    free(processor->inputs);
+    free(processor->output);
+    free(processor->hostFunctions);
+    free(processor);
+}
+
+
+Processor* ProcessorClone(Processor* processor)
+{
+    Processor* clone = (Processor*) calloc(1, sizeof(Processor));
+    if (clone == NULL)
+        return NULL;
+
+    // Machine code isn't used after decoding.
+    clone->machineCode         = {};
+    clone->isMachineCodeShared = false;
+    clone->registers           = processor->registers;
+    clone->executedCount       = processor->executedCount;
+    clone->isVerified          = processor->isVerified;
+    clone->verifiedDepth       = processor->verifiedDepth;
+    clone->status              = processor->status;
+    clone->decodedNum          = processor->decodedNum;
+
+    bool isCloned = DecodedCodeCopy(&processor->decodedCode, &clone->decodedCode) &&
+#ifdef _DEBUG
+                    ProcessorStackCopy(processor->stack, &clone->stack) &&
+#else
+                    OperandStackCopy(&processor->operandStack, &clone->operandStack) &&
+#endif
+                    ProcessorStackCopy(processor->callStack, &clone->callStack) &&
+                    RamClone(&processor->ram, &clone->ram);
+
+    for (size_t inputNum = processor->inputNum; isCloned && inputNum < processor->inputCount;
+                                                inputNum++)
+        isCloned = ProcessorInputAdd(clone, processor->inputs[inputNum]);
+
+    if (isCloned && processor->outputLength != 0)
+    {
+        clone->output = (char*) calloc(processor->outputCapacity, sizeof(char));
+        if (clone->output != NULL)
         {
-            ProcessorDelete(&processor);
-            return false;
+            memcpy(clone->output, processor->output, processor->outputLength + 1);
+            clone->outputLength   = processor->outputLength;
+            clone->outputCapacity = processor->outputCapacity;
         }
+        else
+            isCloned = false;
     }
 
-    ProcessorDelete(&processor);
+    for (size_t functionNum = 0; isCloned && functionNum < processor->hostFunctionCount;
+                                 functionNum++)
+    {
+        HostFunction* hostFunction = processor->hostFunctions + functionNum;
+        isCloned = ProcessorHostFunctionSet(clone, functionNum, hostFunction->function,
+                                                                hostFunction->context);
+    }
+
+    if (!isCloned)
+    {
+        ProcessorDestroy(clone);
+        return NULL;
+    }
+
+    return clone;
+}
+
+
+processorStatus_t ProcessorRun(Processor* processor, size_t instructionBudget, 
+                                                     size_t microsecondBudget)
+{
+    if (processor->status == PROCESSOR_FINISHED || processor->status == PROCESSOR_ERROR)
+        return processor->status;
+
+    const size_t instructionCount = processor->decodedCode.instructionCount;
+    const double deadlineSeconds  = GetSeconds() + (double) microsecondBudget * 1e-6;
+    const size_t executedLimit    = (instructionBudget == 0) ? SIZE_MAX : 
+                                    processor->executedCount + instructionBudget;
+
+    RamMarkChanged(&processor->ram);
+
+    processor->status = PROCESSOR_BUDGET_EXHAUSTED;
+    while (processor->executedCount < executedLimit)
+    {
+        DecodedRange range = {
+            .beginNum      = 0,
+            .endNum        = instructionCount,
+            .entryNum      = processor->decodedNum,
+            .exitNum       = instructionCount,
+            .executedLimit = executedLimit,
+        };
+
+        if (microsecondBudget != 0 && 
+            executedLimit - processor->executedCount > TIME_BUDGET_CHECK_PERIOD)
+            range.executedLimit = processor->executedCount + TIME_BUDGET_CHECK_PERIOD;
+
+        bool runResult = false;
+        if (processor->isVerified)
+            runResult = ProgramRunDecoded<RUN_BUDGETED | RUN_VERIFIED>(processor, NULL, &range);
+        else
+            runResult = ProgramRunDecoded<RUN_BUDGETED>(processor, NULL, &range);
+
+        processor->decodedNum = range.exitNum;
+
+        if (!runResult)
+            processor->status = PROCESSOR_ERROR;
+        else if (processor->status == PROCESSOR_BUDGET_EXHAUSTED && 
+                 range.exitNum >= instructionCount)
+            processor->status = PROCESSOR_FINISHED;
+
+        if (processor->status != PROCESSOR_BUDGET_EXHAUSTED)
+            break;
+
+        if (microsecondBudget != 0 && GetSeconds() >= deadlineSeconds)
+            break;
+    }
+
+    return processor->status;
+}
+
+
+bool ProcessorInputAdd(Processor* processor, instruction_t value)
+{
+    if (processor->inputCount == processor->inputCapacity)
+    {
+        size_t newCapacity = processor->inputCapacity * 2;
+        if (newCapacity < INPUTS_MIN_CAPACITY)
+            newCapacity = INPUTS_MIN_CAPACITY;
+
+        instruction_t* newInputs = (instruction_t*) realloc(processor->inputs, 
+                                                            newCapacity * sizeof(instruction_t));
+        if (newInputs == NULL)
+            return false;
+
+        processor->inputs        = newInputs;
+        processor->inputCapacity = newCapacity;
+    }
+
+    processor->inputs[processor->inputCount++] = value;
     return true;
 }
 
 
+size_t ProcessorGetExecutedCount(Processor* processor)
+{
+    return processor->executedCount;
+}
+
+
+size_t ProcessorGetRamResidentSize(Processor* processor)
+{
+    return RamGetResidentPageCount(&processor->ram) * (size_t) sysconf(_SC_PAGESIZE);
+}
+
+
+const char* ProcessorGetOutput(Processor* processor, size_t* lengthBuffer)
+{
+    *lengthBuffer = processor->outputLength;
+    return (processor->output == NULL) ? "" : processor->output;
+}
+
+
+bool ProcessorHostFunctionSet(Processor* processor, size_t functionNum, 
+                              hostFunction_t function, void* context)
+{
+    if (functionNum >= processor->hostFunctionCount)
+    {
+        HostFunction* newHostFunctions = (HostFunction*) realloc(processor->hostFunctions, 
+                                                          (functionNum + 1) * sizeof(HostFunction));
+        if (newHostFunctions == NULL)
+            return false;
+
+        for (size_t newNum = processor->hostFunctionCount; newNum < functionNum; newNum++)
+            newHostFunctions[newNum] = {};
+
+        processor->hostFunctions     = newHostFunctions;
+        processor->hostFunctionCount = functionNum + 1;
+    }
+
+    processor->hostFunctions[functionNum] = {.function = function, .context = context};
+    return true;
+}
+
+
+// Verifier proves depth of operand stack for the whole program, so it isn't valid after
+// host changes depth. Programs with SYSCALL aren't verified, so host functions lose nothing.
+#define OPERAND_STACK_ (processor->operandStack)
+#define OPERAND_STACK_IS_CHECKED_ true
+
+bool ProcessorPush(Processor* processor, instruction_t value)
+{
+    processor->isVerified = false;
+
+    OPERAND_STACK_PUSH(value);
+    return true;
+}
+
+
+bool ProcessorPop(Processor* processor, instruction_t* valueBuffer)
+{
+    processor->isVerified = false;
+
+    return OPERAND_STACK_POP(*valueBuffer);
+}
+#undef OPERAND_STACK_
+#undef OPERAND_STACK_IS_CHECKED_
+
+
+bool ProcessorRamGet(Processor* processor, size_t cellNum, memoryCell_t* valueBuffer)
+{
+    return RamGetValue(&processor->ram, cellNum, valueBuffer);
+}
+
+
+bool ProcessorRamSet(Processor* processor, size_t cellNum, memoryCell_t value)
+{
+    RamMarkChanged(&processor->ram);
+    return RamCellSet(&processor->ram, cellNum, value);
+}
+
+
 //--------------------------------------------------------------------------------------------------
 
 
-static void ProcessorInit(Processor* processor, const char* programName)
+/**
+ * @param programName If it is NULL, machine code isn't loaded.
+ *
+ * @return false if stacks can't be created. Program which isn't loaded has no code.
+ */
+static bool ProcessorInit(Processor* processor, const char* programName)
 {
-    MachineCodeInitFromFile(&(processor->machineCode), (char*) programName);
-    processor->registers = {};
-    STACK_CREATE(processor->stack,     sizeof(instruction_t));
-    STACK_CREATE(processor->callStack, sizeof(instruction_t));
-    RamInit(&processor->ram);
+    if (programName != NULL)
+        MachineCodeInitFromFile(&(processor->machineCode), (char*) programName);
+
+    processor->registers           = {};
+    processor->ram                 = {.snapshotFd = -1};
+    processor->executedCount       = 0;
+    processor->isVerified          = false;
+    processor->verifiedDepth       = 0;
+    processor->isMachineCodeShared = false;
+
+#ifdef _DEBUG
+    const bool isStackCreated = (STACK_CREATE(processor->stack, sizeof(instruction_t)) == OK);
+#else
+    const bool isStackCreated = OperandStackInit(&processor->operandStack, 
+                                                 OPERAND_STACK_DEFAULT_CAPACITY);
+#endif
+    if (!isStackCreated || STACK_CREATE(processor->callStack, sizeof(instruction_t)) != OK)
+    {
+        ColoredPrintf(RED, "Can't create stacks of processor.\n");
+        return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Layout of options is completed by layout of program and defaults.
+ *
+ * @param options May be NULL.
+ */
+static bool ProcessorRamInit(Processor* processor, ProcessorOptions* options)
+{
+    MemoryLayout layout = {};
+    if (options != NULL)
+        layout = options->layout;
+
+    MemoryLayoutChoose(&layout, &processor->machineCode.layout);
+    if (RamInit(&processor->ram, &layout, options != NULL && options->isRamGuarded))
+        return true;
+
+    ColoredPrintf(RED, "Can't make RAM of %zu cells with screen %zux%zu.\n", layout.ramSize,
+                       layout.screenWidth, layout.screenHeight);
+    return false;
 }
 
 
 static void ProcessorDelete(Processor* processor)
 {
     processor->registers = {};
-    MachineCodeDelete(&(processor->machineCode));
+    if (!processor->isMachineCodeShared)
+        MachineCodeDelete(&(processor->machineCode));
+    DecodedCodeDelete(&processor->decodedCode);
+    JitCodeDelete(&processor->jitCode);
+#ifdef _DEBUG
     StackDelete(&processor->stack);
+#else
+    OperandStackDelete(&processor->operandStack);
+#endif
     StackDelete(&processor->callStack);
     RamDelete(&processor->ram);
+    FrameRendererDelete(&processor->renderer);
+    IoChannelDelete(&processor->io);
+}
+
+
+/**
+ * Decode loaded program of processor created by ProcessorCreate() or ProcessorCreateFromCode().
+ * 
+ * @return processor or NULL if program can't be decoded, then processor is destroyed.
+ */
+static Processor* ProcessorCreateDecoded(Processor* processor, ProcessorOptions* options)
+{
+    ProcessorOptions decodeOptions = {.dispatchMode = DISPATCH_DECODED};
+    if (options != NULL)
+        decodeOptions = *options;
+
+    if (decodeOptions.dispatchMode != DISPATCH_FUSED)
+        decodeOptions.dispatchMode = DISPATCH_DECODED;
+
+    if (!ProcessorDecode(processor, &decodeOptions))
+    {
+        ColoredPrintf(RED, "Can't decode machine code.\n");
+        ProcessorDestroy(processor);
+        return NULL;
+    }
+
+    processor->status = PROCESSOR_BUDGET_EXHAUSTED;
+    return processor;
 }
 
 
+static bool ProcessorDecode(Processor* processor, ProcessorOptions* options)
+{
+    if (!DecodedCodeInit(&processor->decodedCode, &processor->machineCode))
+        return false;
+
+    // JIT has no stack checks, so it translates only verified code.
+    if (options->dispatchMode == DISPATCH_DECODED || options->dispatchMode == DISPATCH_FUSED ||
+        options->dispatchMode == DISPATCH_JIT)
+    {
+        processor->isVerified = DecodedCodeVerify(&processor->decodedCode, 
+                                                  OPERAND_STACK_MAX_VERIFIED_CAPACITY,
+                                                  processor->ram.size, &processor->verifiedDepth);
+        LOG_PRINT(INFO, "Program is %sverified.\n", processor->isVerified ? "" : "not ");
+
+#ifndef _DEBUG
+        // Verified run has no checks, so stack has place for the deepest push at once.
+        if (processor->isVerified && 
+            !OperandStackReserve(&processor->operandStack, processor->verifiedDepth))
+            return false;
+#endif
+    }
+
+    if (options->dispatchMode != DISPATCH_FUSED && options->dispatchMode != DISPATCH_TIERED)
+        return true;
+
+    if (options->pairProfileName == NULL)
+        return DecodedCodeFuse(&processor->decodedCode, NULL);
+
+    PairProfile pairProfile = {};
+    if (!PairProfileInitFromFile(&pairProfile, DECODED_CMD_COUNT, options->pairProfileName))
+        return false;
+
+    bool fuseResult = DecodedCodeFuse(&processor->decodedCode, &pairProfile);
+    PairProfileDelete(&pairProfile);
+
+    return fuseResult;
+}
+
+
+static bool ProgramRunSwitch(Processor* processor)
+{
+    while (processor->machineCode.instructionNum < processor->machineCode.instructionCount)
+    {
+        // printf("%zu\n", processor.machineCode.instructionNum);
+        if (!InstructionExecute(processor))
+            return false;
+    }
+
+    return true;
+}
+
+
+// Machine code isn't verified, so stack is checked.
+#define OPERAND_STACK_ (processor->operandStack)
+#define OPERAND_STACK_IS_CHECKED_ true
+
 #define DEF_CMD_(CMD_NAME, CMD_SET, DO_CMD) \
 {                                           \
     case CMD_NAME:                          \
@@ -94,6 +840,7 @@ static bool InstructionExecute(Processor* processor)
 {
     instruction_t cmdName = 0;
     MachineCodeGetNextInstruction(&(processor->machineCode), &cmdName);
+    processor->executedCount++;
 
     switch (cmdName)
     {
@@ -101,10 +848,532 @@ static bool InstructionExecute(Processor* processor)
 
     case CMD_NAME_WRONG:
     default:
-        LOG_PRINT(ERROR, "Wrong cmdName = %d\n", cmdName);
+        LOG_PRINT(ERROR, "Wrong cmdName = %ld\n", cmdName);
         return false;
     }
 
     return true;
 }
 #undef DEF_CMD_
+#undef OPERAND_STACK_
+#undef OPERAND_STACK_IS_CHECKED_
+
+
+/**
+ * Every command ends with its own copy of DISPATCH_NEXT_(), so the indirect jump 
+ * to the next command is predicted separately for every command.
+ */
+#define DISPATCH_NEXT_()                                                                \
+{                                                                                       \
+    if (MachineCodeGetNextInstruction(&processor->machineCode, &cmdName) != CODE_OK)    \
+    {                                                                                   \
+        OPERAND_STACK_FLUSH_();                                                         \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    if ((size_t) cmdName >= dispatchTableSize)                                          \
+        goto CMD_LABEL_WRONG_;                                                          \
+                                                                                        \
+    processor->executedCount++;                                                         \
+    goto *dispatchTable[cmdName];                                                       \
+}
+
+static bool ProgramRunThreaded(Processor* processor)
+{
+    #define DEF_CMD_(CMD_NAME, ...) \
+        , &&CMD_LABEL_##CMD_NAME
+
+    static void* const dispatchTable[] = 
+    {
+        &&CMD_LABEL_WRONG_
+        #include "commands.h"
+    };
+    #undef DEF_CMD_
+
+    const size_t dispatchTableSize = sizeof(dispatchTable) / sizeof(dispatchTable[0]);
+    instruction_t cmdName = 0;
+
+    OPERAND_STACK_CACHE_();
+    #define OPERAND_STACK_ operandStack
+    #define OPERAND_STACK_IS_CHECKED_ true
+
+    DISPATCH_NEXT_();
+
+    #define DEF_CMD_(CMD_NAME, CMD_SET, DO_CMD) \
+        CMD_LABEL_##CMD_NAME:                   \
+        {                                       \
+            DO_CMD;                             \
+        }                                       \
+        DISPATCH_NEXT_();
+
+    #include "commands.h"
+    #undef DEF_CMD_
+
+CMD_LABEL_WRONG_:
+    LOG_PRINT(ERROR, "Wrong cmdName = %ld\n", cmdName);
+    return false;
+    #undef OPERAND_STACK_
+    #undef OPERAND_STACK_IS_CHECKED_
+}
+#undef DISPATCH_NEXT_
+
+
+/**
+ * Range check is one comparison, beginNum is 0 if there is no range. 
+ * Verified code has no range check, it is finished by DECODED_HALT.
+ */
+#define DISPATCH_NEXT_()                                                        \
+{                                                                               \
+    if (!IS_VERIFIED && instructionNum - beginNum >= rangeSize)                 \
+        DECODED_RUN_STOP_();                                                    \
+                                                                                \
+    if (IS_BUDGETED && processor->executedCount >= executedLimit)               \
+        DECODED_RUN_STOP_();                                                    \
+                                                                                \
+    instruction = processor->decodedCode.instructions + instructionNum++;       \
+    processor->executedCount++;                                                 \
+                                                                                \
+    if (IS_PROFILING)                                                           \
+    {                                                                           \
+        if (previousCmdName != DECODED_CMD_NAME_WRONG)                          \
+            PairProfileAdd(pairProfile, previousCmdName, instruction->cmdName); \
+        previousCmdName = instruction->cmdName;                                 \
+    }                                                                           \
+                                                                                \
+    goto *dispatchTable[instruction->cmdName];                                  \
+}
+
+#define DECODED_RUN_STOP_()                                                     \
+{                                                                               \
+    if (HAS_RANGE)                                                              \
+        range->exitNum = instructionNum;                                        \
+                                                                                \
+    OPERAND_STACK_FLUSH_();                                                     \
+    return true;                                                                \
+}
+
+// In tiered mode call stack is shared with machine code interpreter, so it keeps machine code words.
+#define CALL_STACK_FROM_DECODED_(DECODED_NUM)                                               \
+    (IS_TIERED ? (instruction_t) processor->decodedCode.machineCodeNums[DECODED_NUM]        \
+               : (instruction_t) (DECODED_NUM))
+
+#define CALL_STACK_TO_DECODED_(STACK_VALUE)                                                 \
+    (IS_TIERED ? processor->decodedCode.decodedNums[(size_t) (STACK_VALUE)]                 \
+               : (size_t) (STACK_VALUE))
+
+// Budgeted run reads input given by ProcessorInputAdd() and waits if there is no input.
+#define INPUT_READ_(VALUE_BUFFER)                                                           \
+    (IS_BUDGETED ? ProcessorInputGet(processor, &(VALUE_BUFFER))                            \
+                 : IoChannelRead(&processor->io, &(VALUE_BUFFER)))
+
+#define INPUT_MISSED_()                                                                     \
+{                                                                                           \
+    if (!IS_BUDGETED)                                                                       \
+        return false;                                                                       \
+                                                                                            \
+    processor->status = PROCESSOR_WAITING_FOR_INPUT;                                        \
+    processor->executedCount--;                                                             \
+    instructionNum--;                                                                       \
+    DECODED_RUN_STOP_();                                                                    \
+}
+
+// Budgeted run keeps output for ProcessorGetOutput().
+#define OUTPUT_WRITE_(VALUE)                                                                \
+{                                                                                           \
+    if (IS_BUDGETED ? !ProcessorOutputAdd(processor, VALUE)                                 \
+                    : !IoChannelWrite(&processor->io, VALUE))                               \
+        return false;                                                                       \
+}
+
+#define OUTPUT_FLUSH_()                                                                     \
+{                                                                                           \
+    if (!IS_BUDGETED && !IoChannelFlush(&processor->io))                                    \
+        return false;                                                                       \
+}
+
+// Budgeted run has no screen, frames mustn't be mixed with output of other processors.
+#define SCREEN_DRAW_()                                                                      \
+{                                                                                           \
+    if (IS_BUDGETED)                                                                        \
+    {                                                                                       \
+        LOG_PRINT(ERROR, "DRAW can't be executed by ProcessorRun().\n");                    \
+        return false;                                                                       \
+    }                                                                                       \
+                                                                                            \
+    if (!RamScreenDraw(&processor->ram, &processor->renderer))                              \
+        return false;                                                                       \
+}
+
+// Dispatch of superinstruction counts one command, the rest of its LENGTH is counted here. 
+// So executedCount is the same for decoded and fused code, budget can be exceeded by 
+// a superinstruction which is started just before the limit.
+#define FUSED_EXECUTED_(LENGTH)                                                             \
+    (processor->executedCount += (LENGTH) - 1)
+
+// Cells of guarded RAM are masked, cells out of RAM are caught by ProgramRunGuarded(), 
+// which finds instruction by ramInstruction. Fence keeps its store before the access.
+#define RAM_FAULT_POINT_()                                                                  \
+    (processor->ramInstruction = instruction,                                               \
+     std::atomic_signal_fence(std::memory_order_seq_cst))
+
+#define RAM_GET_(CELL_NUM, VALUE_BUFFER)                                                    \
+    (IS_GUARDED ? (RAM_FAULT_POINT_(),                                                      \
+                   (VALUE_BUFFER) = processor->ram.memory[(CELL_NUM) & processor->ram.mask], \
+                   true)                                                                    \
+                : RamGetValue(&processor->ram, CELL_NUM, &(VALUE_BUFFER)))
+
+#define RAM_SET_(CELL_NUM, VALUE)                                                           \
+    (IS_GUARDED ? (RAM_FAULT_POINT_(),                                                      \
+                   processor->ram.memory[(CELL_NUM) & processor->ram.mask] = (VALUE),       \
+                   true)                                                                    \
+                : RamCellSet(&processor->ram, CELL_NUM, VALUE))
+
+/**
+ * @param range Range of tiered and budgeted runs, other runs execute the whole code from 
+ *              the beginning and range may be NULL.
+ */
+template <unsigned RUN_FLAGS>
+static bool ProgramRunDecoded(Processor* processor, PairProfile* pairProfile, 
+                              DecodedRange* range)
+{
+    const bool IS_PROFILING = (RUN_FLAGS & RUN_PROFILING) != 0;
+    const bool IS_TIERED    = (RUN_FLAGS & RUN_TIERED)    != 0;
+    const bool IS_VERIFIED  = (RUN_FLAGS & RUN_VERIFIED)  != 0;
+    const bool IS_BUDGETED  = (RUN_FLAGS & RUN_BUDGETED)  != 0;
+    const bool IS_GUARDED   = (RUN_FLAGS & RUN_GUARDED)   != 0;
+    const bool HAS_RANGE    = IS_TIERED || IS_BUDGETED;
+
+    #define DEF_DECODED_CMD_(CMD_NAME, ...) \
+        , &&DECODED_LABEL_##CMD_NAME
+
+    static void* const dispatchTable[] = 
+    {
+        &&DECODED_LABEL_WRONG_
+        #include "decodedCommands.h"
+    };
+    #undef DEF_DECODED_CMD_
+
+    const size_t instructionCount   = processor->decodedCode.instructionCount;
+    const size_t beginNum           = HAS_RANGE   ? range->beginNum : 0;
+    const size_t rangeSize          = HAS_RANGE   ? range->endNum - beginNum : instructionCount;
+    const size_t executedLimit      = IS_BUDGETED ? range->executedLimit : 0;
+    size_t instructionNum           = HAS_RANGE   ? range->entryNum : 0;
+    DecodedInstruction* instruction = NULL;
+    size_t previousCmdName          = DECODED_CMD_NAME_WRONG;
+
+    OPERAND_STACK_CACHE_();
+    #define OPERAND_STACK_ operandStack
+    #define OPERAND_STACK_IS_CHECKED_ (!IS_VERIFIED)
+    #define CONST_CELLS_ARE_CHECKED_  (!IS_VERIFIED)
+
+    DISPATCH_NEXT_();
+
+    #define DEF_DECODED_CMD_(CMD_NAME, DO_CMD)  \
+        DECODED_LABEL_##CMD_NAME:               \
+        {                                       \
+            DO_CMD;                             \
+        }                                       \
+        DISPATCH_NEXT_();
+
+    #include "decodedCommands.h"
+    #undef DEF_DECODED_CMD_
+
+DECODED_LABEL_WRONG_:
+    LOG_PRINT(ERROR, "Wrong decoded cmdName = %u\n", instruction->cmdName);
+    return false;
+    #undef OPERAND_STACK_
+    #undef OPERAND_STACK_IS_CHECKED_
+    #undef CONST_CELLS_ARE_CHECKED_
+}
+#undef DISPATCH_NEXT_
+#undef DECODED_RUN_STOP_
+#undef CALL_STACK_FROM_DECODED_
+#undef CALL_STACK_TO_DECODED_
+#undef INPUT_READ_
+#undef INPUT_MISSED_
+#undef RAM_FAULT_POINT_
+#undef RAM_GET_
+#undef RAM_SET_
+#undef OUTPUT_WRITE_
+#undef OUTPUT_FLUSH_
+#undef SCREEN_DRAW_
+#undef FUSED_EXECUTED_
+
+
+/**
+ * Decoded run without checks of RAM cells. Access to guard page jumps back here, then 
+ * run is failed with the cell and the instruction which accesses it.
+ */
+static bool ProgramRunGuarded(Processor* processor)
+{
+    sigjmp_buf faultJump;
+    if (sigsetjmp(faultJump, 1) != 0)
+    {
+        RamFaultRelease();
+
+        const size_t decodedNum     = (size_t) (processor->ramInstruction - 
+                                                processor->decodedCode.instructions);
+        const size_t instructionNum = processor->decodedCode.machineCodeNums[decodedNum];
+        ColoredPrintf(RED, "RAM cell %zu is out of RAM of %zu cells at instruction %zu, "
+                           "line %zu.\n", processor->ram.faultCellNum, processor->ram.size,
+                      instructionNum, MachineCodeGetLineNum(&processor->machineCode, 
+                                                            instructionNum));
+        return false;
+    }
+
+    // Constant cell out of the masked window would wrap to cell in RAM instead of fault.
+    if (!ConstCellsAreGuarded(processor))
+    {
+        LOG_PRINT(INFO, "Constant RAM cell is out of guarded window, RAM is checked.\n");
+        return ProgramRunDecoded<0>(processor, NULL, NULL);
+    }
+
+    if (!RamFaultCatch(&processor->ram, &faultJump))
+        return false;
+
+    const bool runResult = processor->isVerified ? 
+                               ProgramRunDecoded<RUN_GUARDED | RUN_VERIFIED>(processor, NULL, NULL) :
+                               ProgramRunDecoded<RUN_GUARDED>(processor, NULL, NULL);
+
+    RamFaultRelease();
+    return runResult;
+}
+
+
+static bool ConstCellsAreGuarded(Processor* processor)
+{
+    const DecodedInstruction* instructions = processor->decodedCode.instructions;
+    for (size_t instructionNum = 0; instructionNum < processor->decodedCode.instructionCount; 
+                                    instructionNum++)
+    {
+        if ((instructions[instructionNum].cmdName == DECODED_PUSH_RAM_CONST ||
+             instructions[instructionNum].cmdName == DECODED_POP_RAM_CONST) &&
+            (uint64_t) instructions[instructionNum].immediate > processor->ram.mask)
+            return false;
+    }
+
+    return true;
+}
+
+
+/**
+ * Cold code is executed by InstructionExecute(). Backward jumps and calls are counted 
+ * by their targets, target which reaches threshold starts hot region. Hot regions are 
+ * executed by ProgramRunDecoded() over fused code until it leaves region.
+ */
+static bool ProgramRunTiered(Processor* processor, ProcessorOptions* options,
+                             HotRegions* hotRegions, double startSeconds)
+{
+    MachineCode* machineCode = &processor->machineCode;
+    bool isTieringFailed     = false;
+
+    while (machineCode->instructionNum < machineCode->instructionCount)
+    {
+        const size_t        jumpNum = machineCode->instructionNum;
+        const instruction_t cmdName = machineCode->code[jumpNum];
+
+        if (!InstructionExecute(processor))
+            return false;
+
+        const size_t targetNum = machineCode->instructionNum;
+        if (isTieringFailed || !CmdIsJump(cmdName) || (cmdName != CALL && targetNum > jumpNum))
+            continue;
+
+        HotRegion* region = HotRegionsGet(hotRegions, targetNum);
+        if (HotRegionsCount(hotRegions, targetNum) && region == NULL)
+        {
+            region = ProcessorTierUp(processor, options, hotRegions, jumpNum, targetNum, 
+                                     cmdName == CALL, startSeconds);
+            isTieringFailed = (region == NULL);
+        }
+
+        // Region can be left right to the header of another hot region.
+        while (region != NULL)
+        {
+            DecodedRange range = {
+                .beginNum = processor->decodedCode.decodedNums[region->headerNum],
+                .endNum   = processor->decodedCode.decodedNums[region->endNum],
+                .entryNum = processor->decodedCode.decodedNums[region->headerNum],
+            };
+
+            const double enterSeconds = GetSeconds();
+            const size_t enterCount   = processor->executedCount;
+
+            if (!ProgramRunDecoded<RUN_TIERED>(processor, NULL, &range))
+                return false;
+
+            region->enterCount++;
+            region->executedCount       += processor->executedCount - enterCount;
+            hotRegions->fastTierSeconds += GetSeconds() - enterSeconds;
+
+            machineCode->instructionNum = processor->decodedCode.machineCodeNums[range.exitNum];
+            region = HotRegionsGet(hotRegions, machineCode->instructionNum);
+        }
+    }
+
+    return true;
+}
+
+
+/**
+ * Decode and fuse the whole program at the first tier-up, then make region from targetNum 
+ * to the jump for loops and to the first RET for functions.
+ * 
+ * @return new hot region or NULL if program can't be decoded.
+ */
+static HotRegion* ProcessorTierUp(Processor* processor, ProcessorOptions* options, 
+                                  HotRegions* hotRegions, size_t jumpNum, size_t targetNum,
+                                  bool isCall, double startSeconds)
+{
+    const double tierUpStartSeconds = GetSeconds();
+
+    DecodedCode* decodedCode = &processor->decodedCode;
+    if (decodedCode->instructions == NULL && !ProcessorDecode(processor, options))
+    {
+        LOG_PRINT(INFO, "Can't decode program, it is interpreted without tiers.\n");
+        return NULL;
+    }
+
+    const size_t beginNum = decodedCode->decodedNums[targetNum];
+    if (decodedCode->machineCodeNums[beginNum] != targetNum)
+        return NULL;
+
+    size_t endNum = beginNum + 1;
+    if (isCall)
+    {
+        while (endNum < decodedCode->instructionCount && 
+               decodedCode->instructions[endNum - 1].cmdName != DECODED_RET)
+            endNum++;
+    }
+    else
+    {
+        endNum = decodedCode->decodedNums[jumpNum] + 1;
+    }
+
+    HotRegion* region = HotRegionsAdd(hotRegions, targetNum, decodedCode->machineCodeNums[endNum],
+                                      isCall, tierUpStartSeconds - startSeconds);
+
+    hotRegions->tierUpSeconds += GetSeconds() - tierUpStartSeconds;
+    return region;
+}
+
+
+static bool ProcessorInputGet(Processor* processor, instruction_t* valueBuffer)
+{
+    if (processor->inputNum == processor->inputCount)
+        return false;
+
+    *valueBuffer = processor->inputs[processor->inputNum++];
+    if (processor->inputNum == processor->inputCount)
+    {
+        processor->inputNum   = 0;
+        processor->inputCount = 0;
+    }
+
+    return true;
+}
+
+
+/**
+ * Stack has no access to its elements, so they are popped and pushed back to both stacks.
+ */
+static bool ProcessorStackCopy(Stack* source, Stack** copyPtr)
+{
+    if (STACK_CREATE(*copyPtr, sizeof(instruction_t)) != OK)
+        return false;
+
+    instruction_t* elems     = NULL;
+    size_t         elemCount = 0;
+    size_t         capacity  = 0;
+    bool           isCopied  = true;
+
+    instruction_t elem = 0;
+    while (StackPop(source, &elem) == OK)
+    {
+        if (elemCount == capacity)
+        {
+            size_t newCapacity = (capacity == 0) ? STACK_COPY_MIN_CAPACITY : capacity * 2;
+            instruction_t* newElems = (instruction_t*) realloc(elems, 
+                                                               newCapacity * sizeof(instruction_t));
+            if (newElems == NULL)
+            {
+                StackPush(source, &elem);
+                isCopied = false;
+                break;
+            }
+
+            elems    = newElems;
+            capacity = newCapacity;
+        }
+
+        elems[elemCount++] = elem;
+    }
+
+    while (elemCount > 0)
+    {
+        elemCount--;
+        StackPush(source, elems + elemCount);
+        if (isCopied)
+            StackPush(*copyPtr, elems + elemCount);
+    }
+
+    free(elems);
+    return isCopied;
+}
+
+
+static bool ProcessorHostFunctionCall(Processor* processor, instruction_t functionNum)
+{
+    if ((size_t) functionNum >= processor->hostFunctionCount || 
+        processor->hostFunctions[functionNum].function == NULL)
+    {
+        ColoredPrintf(RED, "SYSCALL %ld: host function isn't set.\n", functionNum);
+        return false;
+    }
+
+    HostFunction* hostFunction = processor->hostFunctions + functionNum;
+    return hostFunction->function(processor, hostFunction->context);
+}
+
+
+static bool ProcessorOutputAdd(Processor* processor, instruction_t value)
+{
+    if (processor->outputCapacity - processor->outputLength < OUTPUT_NUMBER_MAX_LENGTH)
+    {
+        size_t newCapacity = processor->outputCapacity * 2;
+        if (newCapacity < OUTPUT_MIN_CAPACITY)
+            newCapacity = OUTPUT_MIN_CAPACITY;
+
+        char* newOutput = (char*) realloc(processor->output, newCapacity);
+        if (newOutput == NULL)
+            return false;
+
+        processor->output         = newOutput;
+        processor->outputCapacity = newCapacity;
+    }
+
+    processor->outputLength += IoNumberFormat(value, processor->output + processor->outputLength);
+    processor->output[processor->outputLength++] = '\n';
+    processor->output[processor->outputLength]   = '\0';
+    return true;
+}
+
+
+static bool CmdIsJump(instruction_t cmdName)
+{
+    switch (cmdName)
+    {
+    case JMP:
+    case JA:
+    case JAE:
+    case JB:
+    case JBE:
+    case JE:
+    case JNE:
+    case CALL:
+        return true;
+
+    default:
+        return false;
+    }
+}
@@ -1,42 +1,23 @@
 #include <string.h>
 
 #include "register64.h"
+#include "mnemonics.h"
 #include "logPrinter.h"
 
 
 //--------------------------------------------------------------------------------------------------
 
 
-#define DEF_REGISTER_(REGISTER_NAME)                    \
-{                                                       \
-    if (strcmp(string, GET_NAME(REGISTER_NAME)) == 0)   \
-        return true;                                    \
-}
-
 bool IsRegister(char* string)
 {
-    #include "registers.h"
-
-    // else
-    return false;    
+    return RegisterNameFromString(string) != REGISTER_NAME_WRONG;
 }
-#undef DEF_REGISTER_
 
 
-#define DEF_REGISTER_(REGISTER_NAME)                   \
-{                                                       \
-    if (strcmp(string, GET_NAME(REGISTER_NAME)) == 0)   \
-        return REGISTER_NAME;                           \
-}
-
 registerName_t AToRegisterName(char* string)
 {
-    #include "registers.h"
-
-    // else
-    return REGISTER_NAME_WRONG;
+    return RegisterNameFromString(string);
 }
-#undef DEF_REGISTER_
 
 
 #define DEF_REGISTER_(REGISTER_NAME) \
@@ -0,0 +1,251 @@
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "sourceText.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static const char* SourceFindWordLine(const char* text, const char* end);
+
+
+#ifdef __AVX2__
+static const size_t BLOCK_SIZE = sizeof(__m256i);
+
+
+static inline uint32_t BlockGetMask(__m256i block, char symbol);
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool SourceTextOpen(SourceText* source, const char* fileName)
+{
+    *source = {};
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd == -1)
+    {
+        LOG_PRINT(ERROR, "Can't open %s.\n", fileName);
+        return false;
+    }
+
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    // The page after source is zeros, so '\0' and blocks after it are readable.
+    const size_t pageSize     = (size_t) sysconf(_SC_PAGESIZE);
+    const size_t size         = (size_t) fileStat.st_size;
+    const size_t reservedSize = (size + pageSize - 1) / pageSize * pageSize + pageSize;
+
+    void* reserved = mmap(NULL, reservedSize, PROT_READ,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (reserved == MAP_FAILED ||
+        (size != 0 && mmap(reserved, size, PROT_READ, MAP_PRIVATE | MAP_FIXED,
+                           fd, 0) == MAP_FAILED))
+    {
+        LOG_PRINT(ERROR, "Can't map %s.\n", fileName);
+        if (reserved != MAP_FAILED)
+            munmap(reserved, reservedSize);
+        close(fd);
+        return false;
+    }
+    close(fd);
+
+    if (size != 0)
+        madvise(reserved, size, MADV_SEQUENTIAL);
+
+    *source = {
+        .text         = (const char*) reserved,
+        .size         = size,
+        .reserved     = reserved,
+        .reservedSize = reservedSize,
+        .releasedSize = 0,
+    };
+    return true;
+}
+
+
+void SourceTextClose(SourceText* source)
+{
+    if (source->reserved != NULL)
+        munmap(source->reserved, source->reservedSize);
+
+    *source = {};
+}
+
+
+size_t SourceTextSplit(const SourceText* source, SourceText* parts, size_t maxPartCount)
+{
+    const char* end       = source->text + source->size;
+    const char* partBegin = source->text;
+    size_t      partCount = 0;
+    for (size_t partNum = 1; partNum < maxPartCount; partNum++)
+    {
+        const size_t partOffset = source->size / maxPartCount * partNum;
+        const char*  partEnd    = SourceFindWordLine(source->text + partOffset, end);
+        if (partEnd == end)
+            break;
+
+        if (partEnd <= partBegin)
+            continue;
+
+        parts[partCount++] = {.text = partBegin, .size = (size_t) (partEnd - partBegin)};
+        partBegin = partEnd;
+    }
+
+    parts[partCount++] = {.text = partBegin, .size = (size_t) (end - partBegin)};
+    return partCount;
+}
+
+
+void SourceTextRelease(SourceText* source, const char* cursor)
+{
+    const size_t passedSize = (size_t) (cursor - source->text);
+    if (passedSize - source->releasedSize < SOURCE_WINDOW_SIZE)
+        return;
+
+    // Part may start inside of page, its first page is left to part before it.
+    // Pages are read from file again if they are touched, nothing is lost.
+    const uintptr_t pageSize      = (uintptr_t) sysconf(_SC_PAGESIZE);
+    const uintptr_t releasedBegin = ((uintptr_t) (source->text + source->releasedSize) + 
+                                     pageSize - 1) / pageSize * pageSize;
+    const uintptr_t releasedEnd   = (uintptr_t) cursor / pageSize * pageSize;
+    if (releasedEnd <= releasedBegin)
+        return;
+
+    madvise((void*) releasedBegin, releasedEnd - releasedBegin, MADV_DONTNEED);
+    source->releasedSize = (size_t) ((const char*) releasedEnd - source->text);
+}
+
+
+const char* SourceSkipSpaces(const char* text, size_t* newlineCount)
+{
+    for (;;)
+    {
+#ifdef __AVX2__
+        const __m256i  block    = _mm256_loadu_si256((const __m256i*) text);
+        const uint32_t newlines = BlockGetMask(block, '\n');
+        const uint32_t spaces   = newlines | BlockGetMask(block, ' ') | BlockGetMask(block, '\t');
+        if (spaces == UINT32_MAX)
+        {
+            *newlineCount += (size_t) __builtin_popcount(newlines);
+            text += BLOCK_SIZE;
+            continue;
+        }
+
+        const uint32_t spaceCount = (uint32_t) __builtin_ctz(~spaces);
+        *newlineCount += (size_t) __builtin_popcount(newlines & ((1u << spaceCount) - 1));
+        text += spaceCount;
+#else
+        while (*text == ' ' || *text == '\t' || *text == '\n')
+        {
+            if (*text == '\n')
+                (*newlineCount)++;
+
+            text++;
+        }
+#endif
+
+        if (*text != ';')
+            return text;
+
+        text = SourceFindLineEnd(text);
+    }
+}
+
+
+const char* SourceFindLineEnd(const char* text)
+{
+#ifdef __AVX2__
+    for (;; text += BLOCK_SIZE)
+    {
+        const __m256i  block = _mm256_loadu_si256((const __m256i*) text);
+        const uint32_t ends  = BlockGetMask(block, '\n') | BlockGetMask(block, '\0');
+        if (ends != 0)
+            return text + __builtin_ctz(ends);
+    }
+#else
+    while (*text != '\n' && *text != '\0')
+        text++;
+
+    return text;
+#endif
+}
+
+
+size_t SourceGetWordLength(const char* text, size_t maxLength)
+{
+#ifdef __AVX2__
+    for (size_t length = 0; length <= maxLength; length += BLOCK_SIZE)
+    {
+        const __m256i  block      = _mm256_loadu_si256((const __m256i*) (text + length));
+        const uint32_t delimiters = BlockGetMask(block, ' ')  | BlockGetMask(block, '\t') |
+                                    BlockGetMask(block, '\n') | BlockGetMask(block, ';')  |
+                                    BlockGetMask(block, '\0');
+        if (delimiters != 0)
+        {
+            const size_t wordLength = length + (size_t) __builtin_ctz(delimiters);
+            return (wordLength <= maxLength) ? wordLength : maxLength + 1;
+        }
+    }
+#else
+    for (size_t length = 0; length <= maxLength; length++)
+    {
+        const char symbol = text[length];
+        if (symbol == ' ' || symbol == '\t' || symbol == '\n' || symbol == ';' || symbol == '\0')
+            return length;
+    }
+#endif
+
+    return maxLength + 1;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+/**
+ * @return the first line after text which starts with a word or end if there is no such line.
+ */
+static const char* SourceFindWordLine(const char* text, const char* end)
+{
+    while (text < end)
+    {
+        text = SourceFindLineEnd(text);
+        if (*text == '\0')
+            return end;
+
+        text++;
+        if (text < end && *text != ' ' && *text != '\t' && *text != '\n' && *text != ';' && 
+                          *text != '\0')
+            return text;
+    }
+
+    return end;
+}
+
+
+#ifdef __AVX2__
+/**
+ * @return bit of every byte of block which is symbol.
+ */
+static inline uint32_t BlockGetMask(__m256i block, char symbol)
+{
+    return (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, _mm256_set1_epi8(symbol)));
+}
+#endif
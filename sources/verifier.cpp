@@ -0,0 +1,405 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "verifier.h"
+#include "virtualMachine.h"
+#include "RAM.h"
+#include "logPrinter.h"
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static const int64_t DEPTH_UNKNOWN      = INT64_MIN;
+static const size_t  MAIN_FUNCTION_NUM  = 0;
+
+
+/**
+ * Depths of function are relative to its entry.
+ */
+struct FunctionSummary
+{
+    size_t  entryNum;
+    int64_t minDepth;           /**< It is never above 0, below 0 means popping caller's elements. */
+    int64_t maxDepth;
+    int64_t returnDepth;        /**< DEPTH_UNKNOWN if no RET is reached yet.                        */
+};
+
+
+struct StackEffect
+{
+    int64_t popCount;
+    int64_t pushCount;
+};
+
+
+struct Verifier
+{
+    DecodedCode*     decodedCode;
+    int64_t          capacity;
+    size_t           ramSize;
+
+    FunctionSummary* functions;
+    size_t           functionCount;
+    size_t*          functionNums;      /**< Number of function + 1 for every entry instruction.  */
+
+    int64_t*         depths;
+    size_t*          stamps;            /**< Depth is known if stamp of instruction is current.  */
+    size_t           stamp;
+    size_t*          workList;
+    size_t           workCount;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool VerifierInit(Verifier* verifier, DecodedCode* decodedCode, size_t capacity);
+
+
+static void VerifierDelete(Verifier* verifier);
+
+
+static bool FunctionAnalyze(Verifier* verifier, size_t functionNum,
+                            FunctionSummary* summaryBuffer);
+
+
+static bool DepthSet(Verifier* verifier, size_t instructionNum, int64_t depth);
+
+
+static bool StackEffectGet(uint8_t cmdName, StackEffect* effectBuffer);
+
+
+static bool SummariesAreEqual(FunctionSummary* firstSummary, FunctionSummary* secondSummary);
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+bool DecodedCodeVerify(DecodedCode* decodedCode, size_t operandStackCapacity, size_t ramSize,
+                       size_t* maxDepthBuffer)
+{
+    Verifier verifier = {};
+    if (!VerifierInit(&verifier, decodedCode, operandStackCapacity))
+        return false;
+
+    verifier.ramSize = ramSize;
+
+    // Call chain of N functions is summarised in N rounds, the rest is for recursion.
+    const size_t maxRoundCount = 2 * verifier.functionCount + 2;
+
+    for (size_t roundNum = 0; roundNum < maxRoundCount; roundNum++)
+    {
+        bool isChanged = false;
+        for (size_t functionNum = 0; functionNum < verifier.functionCount; functionNum++)
+        {
+            FunctionSummary summary = {};
+            if (!FunctionAnalyze(&verifier, functionNum, &summary))
+            {
+                VerifierDelete(&verifier);
+                return false;
+            }
+
+            if (!SummariesAreEqual(&summary, verifier.functions + functionNum))
+            {
+                verifier.functions[functionNum] = summary;
+                isChanged = true;
+            }
+        }
+
+        if (isChanged)
+            continue;
+
+        FunctionSummary* mainSummary = verifier.functions + MAIN_FUNCTION_NUM;
+        bool isVerified = (mainSummary->minDepth >= 0 &&
+                           mainSummary->maxDepth <= verifier.capacity);
+        if (isVerified)
+            *maxDepthBuffer = (size_t) mainSummary->maxDepth;
+        else
+            LOG_PRINT(INFO, "Verifier: operand stack depth is in [%ld, %ld].\n",
+                      mainSummary->minDepth, mainSummary->maxDepth);
+
+        VerifierDelete(&verifier);
+        return isVerified;
+    }
+
+    LOG_PRINT(INFO, "Verifier: depths of functions aren't stable after %zu rounds.\n",
+              maxRoundCount);
+    VerifierDelete(&verifier);
+    return false;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+
+
+static bool VerifierInit(Verifier* verifier, DecodedCode* decodedCode, size_t capacity)
+{
+    const size_t instructionCount = decodedCode->instructionCount;
+
+    verifier->decodedCode  = decodedCode;
+    verifier->capacity     = (int64_t) capacity;
+    verifier->functionNums = (size_t*)  calloc(instructionCount + 1, sizeof(size_t));
+    verifier->depths       = (int64_t*) calloc(instructionCount + 1, sizeof(int64_t));
+    verifier->stamps       = (size_t*)  calloc(instructionCount + 1, sizeof(size_t));
+    verifier->workList     = (size_t*)  calloc(instructionCount + 1, sizeof(size_t));
+
+    size_t callCount = 0;
+    for (size_t instructionNum = 0; instructionNum < instructionCount; instructionNum++)
+        if (decodedCode->instructions[instructionNum].cmdName == DECODED_CALL)
+            callCount++;
+
+    verifier->functions = (FunctionSummary*) calloc(callCount + 1, sizeof(FunctionSummary));
+
+    if (verifier->functionNums == NULL || verifier->depths   == NULL ||
+        verifier->stamps       == NULL || verifier->workList == NULL ||
+        verifier->functions    == NULL)
+    {
+        VerifierDelete(verifier);
+        return false;
+    }
+
+    verifier->functions[MAIN_FUNCTION_NUM] = {.returnDepth = DEPTH_UNKNOWN};
+    verifier->functionNums[0]  = MAIN_FUNCTION_NUM + 1;
+    verifier->functionCount    = 1;
+
+    for (size_t instructionNum = 0; instructionNum < instructionCount; instructionNum++)
+    {
+        DecodedInstruction* instruction = decodedCode->instructions + instructionNum;
+        if (instruction->cmdName != DECODED_CALL)
+            continue;
+
+        const size_t entryNum = instruction->jumpTarget;
+        if (entryNum == 0 || entryNum >= instructionCount)
+        {
+            LOG_PRINT(INFO, "Verifier: CALL at %zu calls %zu.\n", instructionNum, entryNum);
+            VerifierDelete(verifier);
+            return false;
+        }
+
+        if (verifier->functionNums[entryNum] != 0)
+            continue;
+
+        verifier->functions[verifier->functionCount] = {.entryNum    = entryNum,
+                                                        .returnDepth = DEPTH_UNKNOWN};
+        verifier->functionNums[entryNum] = ++verifier->functionCount;
+    }
+
+    return true;
+}
+
+
+static void VerifierDelete(Verifier* verifier)
+{
+    free(verifier->functions);
+    free(verifier->functionNums);
+    free(verifier->depths);
+    free(verifier->stamps);
+    free(verifier->workList);
+
+    *verifier = {};
+}
+
+
+#define JUMP_CASES_(CASE)                                                   \
+    CASE(JA) CASE(JAE) CASE(JB) CASE(JBE) CASE(JE) CASE(JNE)
+
+#define CASE_(CMD_NAME) case DECODED_##CMD_NAME:
+
+/**
+ * Walk through instructions which are reachable from entry of function
+ * with summaries of called functions from the previous round.
+ */
+static bool FunctionAnalyze(Verifier* verifier, size_t functionNum,
+                            FunctionSummary* summaryBuffer)
+{
+    DecodedCode* decodedCode      = verifier->decodedCode;
+    const size_t instructionCount = decodedCode->instructionCount;
+
+    FunctionSummary summary = {
+        .entryNum    = verifier->functions[functionNum].entryNum,
+        .minDepth    = 0,
+        .maxDepth    = 0,
+        .returnDepth = DEPTH_UNKNOWN,
+    };
+
+    verifier->stamp++;
+    verifier->workCount = 0;
+    if (!DepthSet(verifier, summary.entryNum, 0))
+        return false;
+
+    while (verifier->workCount > 0)
+    {
+        const size_t  instructionNum = verifier->workList[--verifier->workCount];
+        const int64_t depth          = verifier->depths[instructionNum];
+
+        // Program is finished there.
+        if (instructionNum == instructionCount)
+            continue;
+
+        DecodedInstruction* instruction = decodedCode->instructions + instructionNum;
+        StackEffect effect = {};
+        if (!StackEffectGet(instruction->cmdName, &effect))
+        {
+            LOG_PRINT(INFO, "Verifier: %s at %zu can't be verified.\n",
+                      DecodedCmdGetName((decodedCmdName_t) instruction->cmdName), instructionNum);
+            return false;
+        }
+
+        const int64_t poppedDepth = depth - effect.popCount;
+        const int64_t nextDepth   = poppedDepth + effect.pushCount;
+        if (poppedDepth < summary.minDepth)
+            summary.minDepth = poppedDepth;
+        if (nextDepth > summary.maxDepth)
+            summary.maxDepth = nextDepth;
+
+        bool isNextOk = true;
+        switch (instruction->cmdName)
+        {
+        case DECODED_PUSH_RAM_CONST:
+        case DECODED_POP_RAM_CONST:
+            if ((uint64_t) instruction->immediate >= verifier->ramSize)
+            {
+                LOG_PRINT(INFO, "Verifier: RAM cell %ld at %zu is out of RAM.\n",
+                          instruction->immediate, instructionNum);
+                return false;
+            }
+
+            isNextOk = DepthSet(verifier, instructionNum + 1, nextDepth);
+            break;
+
+        case DECODED_JMP:
+            isNextOk = DepthSet(verifier, instruction->jumpTarget, nextDepth);
+            break;
+
+        JUMP_CASES_(CASE_)
+            isNextOk = DepthSet(verifier, instruction->jumpTarget, nextDepth) &&
+                       DepthSet(verifier, instructionNum + 1,      nextDepth);
+            break;
+
+        case DECODED_CALL:
+        {
+            FunctionSummary* callee = verifier->functions +
+                                      verifier->functionNums[instruction->jumpTarget] - 1;
+
+            if (depth + callee->minDepth < summary.minDepth)
+                summary.minDepth = depth + callee->minDepth;
+            if (depth + callee->maxDepth > summary.maxDepth)
+                summary.maxDepth = depth + callee->maxDepth;
+
+            // Code after CALL is reached when callee is summarised.
+            if (callee->returnDepth != DEPTH_UNKNOWN)
+                isNextOk = DepthSet(verifier, instructionNum + 1, depth + callee->returnDepth);
+            break;
+        }
+
+        case DECODED_RET:
+            // RET with empty call stack jumps to the beginning.
+            if (functionNum == MAIN_FUNCTION_NUM)
+                isNextOk = DepthSet(verifier, 0, depth);
+            else if (summary.returnDepth == DEPTH_UNKNOWN)
+                summary.returnDepth = depth;
+            else
+                isNextOk = (summary.returnDepth == depth);
+            break;
+
+        default:
+            isNextOk = DepthSet(verifier, instructionNum + 1, nextDepth);
+            break;
+        }
+
+        if (!isNextOk)
+        {
+            LOG_PRINT(INFO, "Verifier: operand stack depth after %zu differs on paths.\n",
+                      instructionNum);
+            return false;
+        }
+
+        if (summary.maxDepth > verifier->capacity || summary.minDepth < -verifier->capacity)
+        {
+            LOG_PRINT(INFO, "Verifier: operand stack depth is unbounded at %zu.\n",
+                      instructionNum);
+            return false;
+        }
+    }
+
+    *summaryBuffer = summary;
+    return true;
+}
+
+
+static bool DepthSet(Verifier* verifier, size_t instructionNum, int64_t depth)
+{
+    if (verifier->stamps[instructionNum] == verifier->stamp)
+        return verifier->depths[instructionNum] == depth;
+
+    verifier->stamps[instructionNum]          = verifier->stamp;
+    verifier->depths[instructionNum]          = depth;
+    verifier->workList[verifier->workCount++] = instructionNum;
+
+    return true;
+}
+
+
+static bool StackEffectGet(uint8_t cmdName, StackEffect* effectBuffer)
+{
+    switch (cmdName)
+    {
+    case DECODED_PUSH_CONST:
+    case DECODED_PUSH_REGISTER:
+    case DECODED_PUSH_REGISTER_CONST:
+    case DECODED_PUSH_RAM_CONST:
+    case DECODED_PUSH_RAM_REGISTER:
+    case DECODED_PUSH_RAM_REGISTER_CONST:
+    case DECODED_IN:
+        *effectBuffer = {.popCount = 0, .pushCount = 1};
+        return true;
+
+    case DECODED_POP_REGISTER:
+    case DECODED_POP_RAM_CONST:
+    case DECODED_POP_RAM_REGISTER:
+    case DECODED_POP_RAM_REGISTER_CONST:
+    case DECODED_OUT:
+        *effectBuffer = {.popCount = 1, .pushCount = 0};
+        return true;
+
+    case DECODED_ADD:
+    case DECODED_SUB:
+    case DECODED_MUL:
+    case DECODED_DIV:
+        *effectBuffer = {.popCount = 2, .pushCount = 1};
+        return true;
+
+    case DECODED_SQRT:
+    case DECODED_SIN:
+    case DECODED_COS:
+        *effectBuffer = {.popCount = 1, .pushCount = 1};
+        return true;
+
+    JUMP_CASES_(CASE_)
+        *effectBuffer = {.popCount = 2, .pushCount = 2};
+        return true;
+
+    case DECODED_DRAW:
+    case DECODED_FLUSH:
+    case DECODED_JMP:
+    case DECODED_CALL:
+    case DECODED_RET:
+        *effectBuffer = {.popCount = 0, .pushCount = 0};
+        return true;
+
+    default:
+        return false;
+    }
+}
+#undef JUMP_CASES_
+#undef CASE_
+
+
+static bool SummariesAreEqual(FunctionSummary* firstSummary, FunctionSummary* secondSummary)
+{
+    return firstSummary->entryNum    == secondSummary->entryNum &&
+           firstSummary->minDepth    == secondSummary->minDepth &&
+           firstSummary->maxDepth    == secondSummary->maxDepth &&
+           firstSummary->returnDepth == secondSummary->returnDepth;
+}
@@ -8,18 +8,18 @@
 //--------------------------------------------------------------------------------------------------
 
 
-static bool VideoMemoryIsIn(Position* position);
+static bool VideoMemoryIsIn(VideoMemory* videoMemory, Position* position);
 static bool IsColor(pixelColor_t color);
 
-static void PixelPrint(Pixel* pixel);
-
 
 //--------------------------------------------------------------------------------------------------
 
 
-bool VideoMemoryInit(VideoMemory* videoMemory)
+bool VideoMemoryInit(VideoMemory* videoMemory, size_t width, size_t height)
 {
-    videoMemory->pixelArray = (Pixel*) calloc(HORIZONTAL_SIZE * VERTICAL_SIZE, sizeof(Pixel));
+    videoMemory->width      = width;
+    videoMemory->height     = height;
+    videoMemory->pixelArray = (Pixel*) calloc(width * height, sizeof(Pixel));
     if (videoMemory->pixelArray == NULL)
         return false;
 
@@ -36,30 +36,12 @@ void VideoMemoryDelete(VideoMemory* videoMemory)
 }
 
 
-void VideoMemoryDraw(VideoMemory* videoMemory)
-{
-    // ColoredPrintf(GREEN, "pixelArray = %p\n", videoMemory->pixelArray);
-    Pixel* pixel = NULL;
-    for (size_t y = 0; y < VERTICAL_SIZE; y++)
-    {
-        for (size_t x = 0; x < HORIZONTAL_SIZE; x++)
-        {
-            pixel = videoMemory->pixelArray + y * HORIZONTAL_SIZE + x;
-            // ColoredPrintf(YELLOW, "symbol = <%c = %zu>, color = <%c = %zu>\n", 
-            //               pixel->symbol, pixel->symbol, pixel->color, pixel->color);
-            PixelPrint(pixel);
-        }
-        putchar('\n');
-    }
-}
-
-
 bool VideoMemorySetColor(VideoMemory* videoMemory, Position position, pixelColor_t color)
 {
-    if (!IsColor(color) || !VideoMemoryIsIn(&position))
+    if (!IsColor(color) || !VideoMemoryIsIn(videoMemory, &position))
         return false;
 
-    Pixel* pixel = videoMemory->pixelArray + position.y * HORIZONTAL_SIZE + position.x;
+    Pixel* pixel = videoMemory->pixelArray + position.y * videoMemory->width + position.x;
     pixel->color = color;
 
     return true;
@@ -68,10 +50,10 @@ bool VideoMemorySetColor(VideoMemory* videoMemory, Position position, pixelColor
 
 bool VideoMemorySetSymbol(VideoMemory* videoMemory, Position position, char symbol)
 {
-    if (!VideoMemoryIsIn(&position))
+    if (!VideoMemoryIsIn(videoMemory, &position))
         return false;
 
-    Pixel* pixel = videoMemory->pixelArray + position.y * HORIZONTAL_SIZE + position.x;
+    Pixel* pixel = videoMemory->pixelArray + position.y * videoMemory->width + position.x;
     pixel->symbol = symbol;
     
     return true;
@@ -81,7 +63,7 @@ bool VideoMemorySetSymbol(VideoMemory* videoMemory, Position position, char symb
 void VideoMemoryReset(VideoMemory* videoMemory)
 {
     Pixel* pixel = NULL;
-    for (size_t pixelNum = 0; pixelNum < HORIZONTAL_SIZE * VERTICAL_SIZE; pixelNum++)
+    for (size_t pixelNum = 0; pixelNum < videoMemory->width * videoMemory->height; pixelNum++)
     {
         pixel = videoMemory->pixelArray + pixelNum;
         *pixel = {.symbol = ' ',
@@ -93,9 +75,9 @@ void VideoMemoryReset(VideoMemory* videoMemory)
 //--------------------------------------------------------------------------------------------------
 
 
-static bool VideoMemoryIsIn(Position* position)
+static bool VideoMemoryIsIn(VideoMemory* videoMemory, Position* position)
 {
-    if (position->x < HORIZONTAL_SIZE && position->y < VERTICAL_SIZE)
+    if (position->x < videoMemory->width && position->y < videoMemory->height)
         return true;
     return false;
 }
@@ -113,24 +95,3 @@ static bool IsColor(pixelColor_t color)
 
     return false;
 }
-
-
-#define PIXEL_PRINT_IN_CASE(COLOR_NAME)                 \
-{                                                       \
-    if (pixel->color == PIXEL_COLOR_##COLOR_NAME)              \
-    {                                                   \
-        ColoredPrintf(COLOR_NAME, "%c", pixel->symbol);  \
-        return;                                         \
-    }                                                   \
-}
-
-
-static void PixelPrint(Pixel* pixel)
-{
-    PIXEL_PRINT_IN_CASE(WHITE);
-    PIXEL_PRINT_IN_CASE(YELLOW);
-    PIXEL_PRINT_IN_CASE(GREEN);
-    PIXEL_PRINT_IN_CASE(RED);
-
-}
-#undef PIXEL_PRINT_IN_CASE